@@ -3,10 +3,52 @@
 #include <geo/xgeo.h>
 #include "alg/xthetastar.h"
 
+#define BOARD_ROWS	50
+#define BOARD_COLS	50
+#define SEARCH_STEP_PER_FRAME 20
+
 ConsolePoint ptCurMouse;
 
+GridPF				gridBoard;
+ThetaStar			thetaStar;
+PathFinder			pathFinder;
+ResumableSearch		pathSearch;
+stCellIdxPF			stSearchStart{ 0, 0 };
+std::vector<stCellPF*> vecPath;
+
+void DrawSearch(ConsoleGraphics* pGraphic)
+{
+	for (int y = 0; y < gridBoard.Rows(); y++)
+	{
+		for (int x = 0; x < gridBoard.Cols(); x++)
+		{
+			stCellPF* pCell = gridBoard.Get(x, y);
+			if (pCell && pCell->stData.fWeight > 0)
+				pGraphic->SetColorCell(MAKE_CID(x, y), { 120, 120, 120 });
+		}
+	}
+
+	// Visited cells from the recorded event stream
+	auto pEvents = pathFinder.GetEvents();
+	if (pEvents)
+	{
+		for (auto& event : *pEvents)
+		{
+			if (event.eType == SearchEventPop)
+				pGraphic->SetColorCell(MAKE_CID(event.stIdx.nX, event.stIdx.nY), { 60, 90, 160 });
+		}
+	}
+
+	for (auto pCell : vecPath)
+	{
+		pGraphic->SetColorCell(MAKE_CID(pCell->stIdx.nX, pCell->stIdx.nY), { 0, 200, 0 });
+	}
+}
+
 void DrawCallback(ConsoleHandle* handle, ConsoleGraphics* pGraphic)
 {
+	DrawSearch(pGraphic);
+
 	//std::cout << "draw \n" << std::endl;
 
 	//ConsoleColor col{ 255, 0, 0 };
@@ -45,10 +87,25 @@ void MouseCallback(ConsoleHandle* handle, MouseEventInfo* pMouse)
 		if (pMouse->m_MouseButton == ConsoleMouseButton::MOUSE_BUTTON_LEFT)
 		{
 			OutputDebugString(_T("[left] mouse down \n"));
+
+			// Search from the previous target to the clicked cell
+			stCellIdxPF stTarget{ pMouse->m_MousePos.x, pMouse->m_MousePos.y };
+			vecPath.clear();
+			pathFinder.Begin(pathSearch, stSearchStart, stTarget);
+			stSearchStart = stTarget;
 		}
 		else if (pMouse->m_MouseButton == ConsoleMouseButton::MOUSE_BUTTON_RIGHT)
 		{
 			OutputDebugString(_T("[right] mouse down \n"));
+
+			// Toggle obstacle
+			stCellPF* pCell = gridBoard.Get(pMouse->m_MousePos.x, pMouse->m_MousePos.y);
+			if (pCell)
+			{
+				stCellDataPF data = pCell->stData;
+				data.fWeight = data.fWeight > 0 ? 0.f : 1.f;
+				gridBoard.SetData(pMouse->m_MousePos.x, pMouse->m_MousePos.y, data);
+			}
 		}
 	}
 	else if (pMouse->m_MouseState == ConsoleMouseState::MOUSE_UP_STATE)
@@ -70,11 +127,17 @@ void MouseCallback(ConsoleHandle* handle, MouseEventInfo* pMouse)
 
 int main()
 {
+	std::vector<float> vecWeights(BOARD_ROWS * BOARD_COLS, 0.f);
+	gridBoard.BuildFrom(vecWeights, BOARD_ROWS, BOARD_COLS);
+
+	pathFinder.Prepar(&gridBoard, &thetaStar);
+	pathFinder.SetOptionRecordEvents(true);
+
 	WinConsoleHandle win;
 	win.SetMouseEventCallback(MouseCallback);
 	win.SetKeyboardEventCallback(KeyboardCallback);
 	win.SetDrawCallback(DrawCallback);
-	win.SetWindowSize(50, 50);
+	win.SetWindowSize(BOARD_ROWS, BOARD_COLS);
 	//win.SetCellSize(20, 20);
 
 	if (!win.Create(_T("console handle"), 100, 100, 680, 680))
@@ -89,6 +152,17 @@ int main()
 	{
 		win.Draw();
 
-		win.WaitEvent();
+		if (pathSearch.IsRunning())
+		{
+			// Animate : a few expansions per frame
+			if (!pathSearch.Step(SEARCH_STEP_PER_FRAME))
+				vecPath = pathSearch.GetPath();
+
+			win.PollEvent();
+		}
+		else
+		{
+			win.WaitEvent();
+		}
 	}
 }
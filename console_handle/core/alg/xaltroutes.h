@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Alternative routes (penalty method, diversity threshold)
+* @file  : xaltroutes.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XALTROUTES_H
+#define XALTROUTES_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xastar.h"
+
+#define ALTROUTES_MAX			32		// routes per search (one bit per route and cell)
+#define ALTROUTES_ATTEMPTS		4		// searches per wanted route
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stAltRoute
+{
+	float					fCost{ 0.f };		// without the penalties
+	float					fOverlap{ 0.f };	// largest share of its cells on a route found before
+	std::vector<stCellPF*>	vecPath;
+} stAltRoutePF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// AlternativeRoutes class
+
+/*
+* Penalty method : the a-star is run again and again, each run adds a penalty
+* to the cells of the route found (AStar::SetCellPenalty) so the next one is
+* pushed aside. A route is kept when the share of its inner cells lying on
+* any kept route is at most the overlap threshold, the search ends with k
+* routes, when a route costs more than the stretch times the best one or
+* after ALTROUTES_ATTEMPTS runs per route.
+* The a-star, its node pool and the penalty / route masks (8 bytes per cell)
+* are kept between the runs and the searches, only the touched cells are
+* reset.
+*/
+class AlternativeRoutes
+{
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/* Cost added to a cell for each route through it (a straight move costs 1) */
+	void SetPenalty(const float fPenalty) noexcept
+	{
+		m_fPenalty = std::max(fPenalty, 0.01f);
+	}
+
+	/* Diversity threshold : largest share of a route on an earlier one, [0, 1] */
+	void SetMaxOverlap(const float fMaxOverlap) noexcept
+	{
+		m_fMaxOverlap = fMaxOverlap;
+	}
+
+	/* Routes costing more than fMaxStretch x the best one end the search */
+	void SetMaxStretch(const float fMaxStretch) noexcept
+	{
+		m_fMaxStretch = fMaxStretch;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Up to nCount diverse routes from start to target, by cost
+	*! @return : number of routes
+	*******************************************************************************/
+	size_t Search(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target, size_t nCount,
+				  std::vector<stAltRoutePF>& vecRoutes)
+	{
+		vecRoutes.clear();
+		nCount = std::min<size_t>(nCount, ALTROUTES_MAX);
+
+		if (!pGridBoard || pGridBoard->Length() == 0 || nCount == 0)
+			return 0;
+
+		Prepare(pGridBoard);
+
+		size_t nAttempts = nCount * ALTROUTES_ATTEMPTS;
+
+		while (vecRoutes.size() < nCount && nAttempts-- > 0)
+		{
+			m_Finder.Search(start, target, m_vecPath);
+			if (m_vecPath.empty())
+				break;
+
+			float fCost = PathCost(m_vecPath);
+			if (!vecRoutes.empty() && fCost > vecRoutes.front().fCost * m_fMaxStretch)
+				break;
+
+			float fOverlap = Overlap(m_vecPath, vecRoutes.size());
+
+			// rejected routes are penalized too, the next run moves away from them
+			for (stCellPF* pCell : m_vecPath)
+			{
+				uint32_t nIdx = Index(pCell);
+				if (m_vecPenalty[nIdx] == 0.f)
+					m_vecTouched.push_back(nIdx);
+
+				m_vecPenalty[nIdx] += m_fPenalty;
+			}
+
+			if (!vecRoutes.empty() && fOverlap > m_fMaxOverlap)
+				continue;
+
+			for (stCellPF* pCell : m_vecPath)
+				m_vecRoutes[Index(pCell)] |= uint32_t(1) << vecRoutes.size();
+
+			vecRoutes.emplace_back();
+			vecRoutes.back().fCost = fCost;
+			vecRoutes.back().fOverlap = fOverlap;
+			vecRoutes.back().vecPath = m_vecPath;
+		}
+
+		for (uint32_t nIdx : m_vecTouched)
+		{
+			m_vecPenalty[nIdx] = 0.f;
+			m_vecRoutes[nIdx] = 0;
+		}
+		m_vecTouched.clear();
+
+		std::stable_sort(vecRoutes.begin(), vecRoutes.end(), [](const stAltRoutePF& a, const stAltRoutePF& b)
+		{
+			return a.fCost < b.fCost;
+		});
+
+		return vecRoutes.size();
+	}
+
+protected:
+	uint32_t Index(const stCellPF* pCell) const noexcept
+	{
+		return uint32_t(pCell->stIdx.nX + size_t(pCell->stIdx.nY) * m_pGridBoard->Cols());
+	}
+
+	void Prepare(GridPF* pGridBoard)
+	{
+		if (m_pGridBoard != pGridBoard || m_vecPenalty.size() != pGridBoard->Length())
+		{
+			m_vecPenalty.assign(pGridBoard->Length(), 0.f);
+			m_vecRoutes.assign(pGridBoard->Length(), 0);
+		}
+
+		m_pGridBoard = pGridBoard;
+
+		m_AStar.SetCellPenalty(m_vecPenalty.data());
+		m_Finder.SetOption(m_Option);
+		m_Finder.Prepar(m_pGridBoard, &m_AStar);
+	}
+
+	static float PathCost(const std::vector<stCellPF*>& vecPath) noexcept
+	{
+		float fCost = 0.f;
+		for (size_t i = 1; i < vecPath.size(); i++)
+		{
+			bool bCross = vecPath[i]->stIdx.nX != vecPath[i - 1]->stIdx.nX &&
+						  vecPath[i]->stIdx.nY != vecPath[i - 1]->stIdx.nY;
+			fCost += bCross ? 1.412f : 1.f;
+		}
+
+		return fCost;
+	}
+
+	/* Largest share of the inner cells (not start, target) on one of the nRoutes kept */
+	float Overlap(const std::vector<stCellPF*>& vecPath, const size_t nRoutes) const
+	{
+		if (nRoutes == 0)
+			return 0.f;
+
+		if (vecPath.size() <= 2)
+			return 1.f;
+
+		uint32_t arShared[ALTROUTES_MAX] = { 0 };
+
+		for (size_t i = 1; i + 1 < vecPath.size(); i++)
+		{
+			uint32_t nMask = m_vecRoutes[Index(vecPath[i])];
+			for (size_t r = 0; nMask != 0; r++, nMask >>= 1)
+			{
+				if (nMask & 1)
+					arShared[r]++;
+			}
+		}
+
+		uint32_t nMax = *std::max_element(arShared, arShared + nRoutes);
+
+		return float(nMax) / float(vecPath.size() - 2);
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	float						m_fPenalty{ 0.5f };
+	float						m_fMaxOverlap{ 0.6f };
+	float						m_fMaxStretch{ 1.5f };
+
+	GridPF*						m_pGridBoard{ nullptr };
+	AStar						m_AStar;
+	PathFinder					m_Finder;
+
+	std::vector<float>			m_vecPenalty;	// per cell
+	std::vector<uint32_t>		m_vecRoutes;	// per cell, bit r : on kept route r
+	std::vector<uint32_t>		m_vecTouched;	// cells to reset
+	std::vector<stCellPF*>		m_vecPath;
+};
+
+#endif // !XALTROUTES_H
@@ -0,0 +1,670 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Anya optimal any-angle pathfinding (interval search, no preprocessing)
+* @file  : xanya.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XANYA_H
+#define XANYA_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+
+#define ANYA_NONE		UINT32_MAX
+#define ANYA_EPSILON	1e-7
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+/* Point of the board plane, cell (x, y) covers [x, x + 1] x [y, y + 1] */
+typedef struct _stAnyaPoint
+{
+	float	fX{ 0.f };
+	float	fY{ 0.f };
+} stAnyaPointPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// AnyaSearch class
+
+/*
+* Anya (Harabor et al.) : search nodes are (interval of a grid line, root
+* point) where every point of the interval is seen from the root. A node
+* projects its interval to the next line through the free cells (same root)
+* and turns around the obstacle corners at its ends (the corner becomes the
+* root), so the result is the Euclidean shortest path among the blocked
+* cells, turning only at obstacle corners, without any preprocessing.
+* Start and target are cell centers : the board is searched at half cell
+* resolution so that they lie on the grid lines, the corners stay on the
+* even lines. A path may touch the obstacles but not cross between two
+* blocked cells touching by a corner (same rule as the diagonal moves).
+* A corner is kept as root once, by the first cheapest way to it (ties are
+* dropped, they would grow the same cones again).
+* Scratch : 9 bytes per cell for the runs of the rows (rebuilt when the grid
+* version changes) + 16 per grid vertex for the root costs.
+*/
+class AnyaSearch : public PathFinding
+{
+	typedef struct _stAnyaRoot
+	{
+		int				nX{ 0 };			// half cell units
+		int				nY{ 0 };
+		double			fCost{ 0.0 };
+		unsigned int	nPrev{ ANYA_NONE };
+	} stAnyaRootPF;
+
+	typedef struct _stAnyaVertex
+	{
+		double			fCost{ DBL_MAX };	// best root cost at this corner
+		unsigned int	nGeneration{ 0 };
+		unsigned int	nRoot{ ANYA_NONE };
+	} stAnyaVertexPF;
+
+	typedef struct _stAnyaNode
+	{
+		double			fScore{ 0.0 };
+		double			fLeft{ 0.0 };
+		double			fRight{ 0.0 };
+		int				nRow{ 0 };
+		unsigned int	nRoot{ 0 };
+		bool			bGoal{ false };
+
+		bool operator<(const _stAnyaNode& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stAnyaNodePF;
+
+public:
+	/* Exact path of the last query (board units), empty if none */
+	const std::vector<stAnyaPointPF>& Points() const noexcept
+	{
+		return m_vecPoints;
+	}
+
+	/* Euclidean length of the last path */
+	float Cost() const noexcept
+	{
+		return m_fCost;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Shortest any-angle path between the centers of two cells
+	*! @param  : [out] vecPoints : start center, obstacle corners, target center
+	*! @return : true if found
+	*******************************************************************************/
+	bool Search(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target, std::vector<stAnyaPointPF>& vecPoints)
+	{
+		vecPoints.clear();
+		m_fCost = 0.f;
+
+		if (!pGridBoard || pGridBoard->Length() == 0)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		PrepareBoard();
+
+		if (IsBlockedCell(start.nX, start.nY) || IsBlockedCell(target.nX, target.nY))
+			return false;
+
+		vecPoints.push_back({ start.nX + 0.5f, start.nY + 0.5f });
+
+		if (start.nX == target.nX && start.nY == target.nY)
+			return true;
+
+		PrepareSearch();
+
+		m_nTargetX = 2 * target.nX + 1;
+		m_nTargetY = 2 * target.nY + 1;
+
+		// start root : its row both ways and the lines above / below
+		m_vecRoots.push_back({ 2 * start.nX + 1, 2 * start.nY + 1, 0.0, ANYA_NONE });
+
+		const int nStartX = 2 * start.nX + 1, nStartY = 2 * start.nY + 1;
+		PushFlat(nStartY, nStartX, -1, 0);
+		PushFlat(nStartY, nStartX, 1, 0);
+		PushPointCone(nStartX, nStartY, 1, 0, -DBL_MAX, DBL_MAX);
+		PushPointCone(nStartX, nStartY, -1, 0, -DBL_MAX, DBL_MAX);
+
+		while (!m_Open.Empty())
+		{
+			stAnyaNodePF node = m_Open.Pop();
+
+			// root reached cheaper since this node was pushed
+			if (IsStale(node.nRoot))
+				continue;
+
+			StatsPop(NodeCell(node));
+
+			if (node.bGoal)
+			{
+				MakePath(node.nRoot, vecPoints);
+				m_fCost = float(node.fScore * 0.5);
+				return true;
+			}
+
+			if (m_vecRoots[node.nRoot].nY == node.nRow)
+				ExpandFlat(node);
+			else
+				ExpandCone(node);
+		}
+
+		vecPoints.clear();
+		return false;
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	/*
+	* Waypoint cells : start, the free cell off each turning corner, target
+	* (the exact polyline is in Points())
+	*/
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		StatsBegin();
+
+		if (Search(pGridBoard, start, target, m_vecPoints))
+		{
+			path.push_back(pGridBoard->Get(start));
+
+			for (size_t i = 1; i + 1 < m_vecPoints.size(); i++)
+			{
+				stCellPF* pCell = CornerCell(int(std::lround(m_vecPoints[i].fX)), int(std::lround(m_vecPoints[i].fY)));
+				if (pCell && pCell != path.back())
+					path.push_back(pCell);
+			}
+
+			if (path.back() != pGridBoard->Get(target))
+				path.push_back(pGridBoard->Get(target));
+		}
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	/*
+	* Board at half cell resolution : cell (x, y) is the half cells [2x, 2x + 1] x [2y, 2y + 1].
+	* Each board cell stores the bounds of the run of same state cells in its row.
+	*/
+	void PrepareBoard()
+	{
+		if (m_pBoardBuilt == m_pGridBoard && m_nBoardVersion == m_pGridBoard->Version() &&
+			m_nCols == m_pGridBoard->Cols() && m_nRows == m_pGridBoard->Rows())
+			return;
+
+		m_pBoardBuilt = m_pGridBoard;
+		m_nBoardVersion = m_pGridBoard->Version();
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+
+		size_t szCells = size_t(m_nCols) * m_nRows;
+		m_vecBlocked.assign(szCells, 0);
+		m_vecRunBegin.assign(szCells, 0);
+		m_vecRunEnd.assign(szCells, 0);
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = m_pGridBoard->Get(x, y);
+				m_vecBlocked[x + size_t(y) * m_nCols] = (!pCell || pCell->stData.fWeight > 0) ? 1 : 0;
+			}
+
+			int nBegin = 0;
+			for (int x = 1; x <= m_nCols; x++)
+			{
+				size_t nRow = size_t(y) * m_nCols;
+				if (x < m_nCols && m_vecBlocked[nRow + x] == m_vecBlocked[nRow + x - 1])
+					continue;
+
+				for (int i = nBegin; i < x; i++)
+				{
+					m_vecRunBegin[nRow + i] = nBegin;
+					m_vecRunEnd[nRow + i] = x;
+				}
+
+				nBegin = x;
+			}
+		}
+	}
+
+	void PrepareSearch()
+	{
+		m_Open.Clear();
+		m_vecRoots.clear();
+		m_Vertices.Begin(size_t(m_nCols + 1) * (m_nRows + 1));
+	}
+
+	bool IsBlockedCell(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return true;
+
+		return m_vecBlocked[x + size_t(y) * m_nCols] != 0;
+	}
+
+	/* Half cell (cx, cy) */
+	bool Blocked(const int cx, const int cy) const noexcept
+	{
+		if (cx < 0 || cy < 0)
+			return true;
+
+		return IsBlockedCell(cx >> 1, cy >> 1);
+	}
+
+	/* Same state run of the half cell row cy holding cx : [nBegin, nEnd) in half cells */
+	void Run(const int cx, const int cy, int& nBegin, int& nEnd) const noexcept
+	{
+		size_t nCell = size_t(cx >> 1) + size_t(cy >> 1) * m_nCols;
+		nBegin = 2 * m_vecRunBegin[nCell];
+		nEnd = 2 * m_vecRunEnd[nCell];
+	}
+
+	bool InRow(const int cy) const noexcept
+	{
+		return cy >= 0 && cy < 2 * m_nRows;
+	}
+
+	/* A path can go through the vertex : no diagonal pair of blocked cells, at least 2 free */
+	bool IsPassable(const int x, const int y) const noexcept
+	{
+		bool b00 = Blocked(x - 1, y - 1), b10 = Blocked(x, y - 1);
+		bool b01 = Blocked(x - 1, y), b11 = Blocked(x, y);
+
+		if ((b00 && b11) || (b10 && b01))
+			return false;
+
+		return (b00 + b10 + b01 + b11) <= 2;
+	}
+
+	/* Ray of direction nDir (x sign) crossing the line at the vertex x, from cell row nBehind to nAhead */
+	bool CanCross(const int x, const int nBehind, const int nAhead, const int nDir) const noexcept
+	{
+		if (nDir > 0)
+			return !Blocked(x - 1, nBehind) && !Blocked(x, nAhead) && !(Blocked(x, nBehind) && Blocked(x - 1, nAhead));
+
+		if (nDir < 0)
+			return !Blocked(x, nBehind) && !Blocked(x - 1, nAhead) && !(Blocked(x - 1, nBehind) && Blocked(x, nAhead));
+
+		return (!Blocked(x - 1, nBehind) || !Blocked(x, nBehind)) && (!Blocked(x - 1, nAhead) || !Blocked(x, nAhead)) &&
+			   !(Blocked(x - 1, nBehind) && Blocked(x, nAhead)) && !(Blocked(x, nBehind) && Blocked(x - 1, nAhead));
+	}
+
+	static bool IsInteger(const double f, int& n) noexcept
+	{
+		double fRound = std::floor(f + 0.5);
+		n = int(fRound);
+
+		return std::fabs(f - fRound) < ANYA_EPSILON;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Cone node : project the interval to the next line (same root),
+	*!           turn around the corners at its ends (new roots)
+	*******************************************************************************/
+	void ExpandCone(const stAnyaNodePF& node)
+	{
+		const stAnyaRootPF root = m_vecRoots[node.nRoot];
+		const int nDir = node.nRow > root.nY ? 1 : -1;
+		const int nNext = node.nRow + nDir;
+		const int nAhead = nDir > 0 ? node.nRow : node.nRow - 1;
+		const int nBehind = nDir > 0 ? node.nRow - 1 : node.nRow;
+		const double fRatio = double(nNext - root.nY) / double(node.nRow - root.nY);
+
+		auto funProject = [&](const double x)
+		{
+			return root.nX + (x - root.nX) * fRatio;
+		};
+
+		// observable : the free runs of the row ahead under the interval
+		if (InRow(nAhead))
+		{
+			int nCell = std::max(int(std::ceil(node.fLeft - ANYA_EPSILON)) - 1, 0);
+
+			while (nCell < 2 * m_nCols && nCell <= node.fRight + ANYA_EPSILON)
+			{
+				int nBegin, nEnd;
+				Run(nCell, nAhead, nBegin, nEnd);
+
+				if (!Blocked(nCell, nAhead))
+				{
+					double fLow = std::max(node.fLeft, double(nBegin));
+					double fHigh = std::min(node.fRight, double(nEnd));
+
+					int nVertex;
+					bool bCross = fLow <= fHigh + ANYA_EPSILON;
+
+					// one ray through a vertex at the run end
+					if (bCross && fHigh - fLow < ANYA_EPSILON && IsInteger(fLow, nVertex))
+					{
+						int nRayDir = (fLow > root.nX + ANYA_EPSILON) - (fLow < root.nX - ANYA_EPSILON);
+						bCross = CanCross(nVertex, nBehind, nAhead, nRayDir);
+					}
+
+					if (bCross)
+					{
+						double fLeft = std::max(funProject(fLow), double(nBegin));
+						double fRight = std::min(funProject(fHigh), double(nEnd));
+
+						if (fLeft <= fRight + ANYA_EPSILON)
+							PushNode(std::min(fLeft, fRight), fRight, nNext, node.nRoot);
+
+						// shadow of a blocked cell ahead : turn around its corner on this line
+						if (fLow - nBegin < ANYA_EPSILON && funProject(nBegin) > nBegin + ANYA_EPSILON &&
+							IsPassable(nBegin, node.nRow))
+						{
+							unsigned int nCorner = AddRoot(nBegin, node.nRow, node.nRoot);
+							if (nCorner != ANYA_NONE)
+								PushNode(nBegin, std::min(funProject(nBegin), double(nEnd)), nNext, nCorner);
+						}
+
+						if (nEnd - fHigh < ANYA_EPSILON && funProject(nEnd) < nEnd - ANYA_EPSILON &&
+							IsPassable(nEnd, node.nRow))
+						{
+							unsigned int nCorner = AddRoot(nEnd, node.nRow, node.nRoot);
+							if (nCorner != ANYA_NONE)
+								PushNode(std::max(funProject(nEnd), double(nBegin)), nEnd, nNext, nCorner);
+						}
+					}
+				}
+
+				nCell = nEnd;
+			}
+		}
+
+		// non observable : corners of blocked cells behind the interval ends
+		int nVertex;
+		if (IsInteger(node.fLeft, nVertex) && Blocked(nVertex - 1, nBehind) && !Blocked(nVertex - 1, nAhead) &&
+			IsPassable(nVertex, node.nRow))
+		{
+			unsigned int nCorner = AddRoot(nVertex, node.nRow, node.nRoot);
+			if (nCorner != ANYA_NONE)
+			{
+				PushFlat(node.nRow, nVertex, -1, nCorner);
+
+				int nBegin, nEnd;
+				Run(nVertex - 1, nAhead, nBegin, nEnd);
+
+				double fRight = std::min(funProject(node.fLeft), double(nEnd));
+				if (nBegin <= fRight + ANYA_EPSILON)
+					PushNode(nBegin, std::max(fRight, double(nBegin)), nNext, nCorner);
+			}
+		}
+
+		if (IsInteger(node.fRight, nVertex) && Blocked(nVertex, nBehind) && !Blocked(nVertex, nAhead) &&
+			IsPassable(nVertex, node.nRow))
+		{
+			unsigned int nCorner = AddRoot(nVertex, node.nRow, node.nRoot);
+			if (nCorner != ANYA_NONE)
+			{
+				PushFlat(node.nRow, nVertex, 1, nCorner);
+
+				int nBegin, nEnd;
+				Run(nVertex, nAhead, nBegin, nEnd);
+
+				double fLeft = std::max(funProject(node.fRight), double(nBegin));
+				if (fLeft <= nEnd + ANYA_EPSILON)
+					PushNode(std::min(fLeft, double(nEnd)), nEnd, nNext, nCorner);
+			}
+		}
+	}
+
+	/*******************************************************************************
+	*! @brief  : Flat node : go on along the line (same root), turn up / down at
+	*!           the far end when an obstacle ends there (new root)
+	*******************************************************************************/
+	void ExpandFlat(const stAnyaNodePF& node)
+	{
+		const stAnyaRootPF& root = m_vecRoots[node.nRoot];
+		const int nDir = node.fLeft >= root.nX - ANYA_EPSILON ? 1 : -1;
+
+		int nEndX;
+		if (!IsInteger(nDir > 0 ? node.fRight : node.fLeft, nEndX))
+			return;
+
+		const unsigned int nRoot = node.nRoot;
+		const int nRow = node.nRow;
+
+		PushFlat(nRow, nEndX, nDir, nRoot);
+
+		// cells passed (near) and beyond (far) the end, in the rows above / below
+		int nNear = nDir > 0 ? nEndX - 1 : nEndX;
+		int nFar = nDir > 0 ? nEndX : nEndX - 1;
+
+		if (!IsPassable(nEndX, nRow))
+			return;
+
+		for (int nSide = -1; nSide <= 1; nSide += 2)
+		{
+			int nCellRow = nSide > 0 ? nRow : nRow - 1;
+			if (!InRow(nCellRow) || !Blocked(nNear, nCellRow) || Blocked(nFar, nCellRow))
+				continue;
+
+			unsigned int nCorner = AddRoot(nEndX, nRow, nRoot);
+			if (nCorner != ANYA_NONE)
+				PushPointCone(nEndX, nRow, nSide, nCorner, -DBL_MAX, DBL_MAX);
+		}
+	}
+
+	/* Flat interval from x in nDir up to the next corner or the end of the line */
+	void PushFlat(const int nRow, const int x, const int nDir, const unsigned int nRoot)
+	{
+		int nCell = nDir > 0 ? x : x - 1;
+		if (nCell < 0 || nCell >= 2 * m_nCols)
+			return;
+
+		if (x != m_vecRoots[nRoot].nX && !IsPassable(x, nRow))
+			return;
+
+		const int nUp = nRow, nDown = nRow - 1;
+		bool bUp = InRow(nUp) && !Blocked(nCell, nUp);
+		bool bDown = InRow(nDown) && !Blocked(nCell, nDown);
+
+		if (!bUp && !bDown)
+			return;
+
+		// next change of state above or below
+		int nEnd = nDir > 0 ? 2 * m_nCols : 0;
+		for (int nCellRow = nDown; nCellRow <= nUp; nCellRow++)
+		{
+			if (!InRow(nCellRow))
+				continue;
+
+			int nBegin, nRunEnd;
+			Run(nCell, nCellRow, nBegin, nRunEnd);
+			nEnd = nDir > 0 ? std::min(nEnd, nRunEnd) : std::max(nEnd, nBegin);
+		}
+
+		PushNode(std::min(x, nEnd), std::max(x, nEnd), nRow, nRoot);
+	}
+
+	/* Points of the next line seen from the vertex (x, y) through the row of cells in nDir */
+	void PushPointCone(const int x, const int y, const int nDir, const unsigned int nRoot,
+					   const double fMin, const double fMax)
+	{
+		const int nAhead = nDir > 0 ? y : y - 1;
+		if (!InRow(nAhead))
+			return;
+
+		int nCell = !Blocked(x - 1, nAhead) ? x - 1 : (!Blocked(x, nAhead) ? x : -1);
+		if (nCell < 0 || nCell >= 2 * m_nCols)
+			return;
+
+		int nBegin, nEnd;
+		Run(nCell, nAhead, nBegin, nEnd);
+
+		double fLeft = std::max(double(nBegin), fMin), fRight = std::min(double(nEnd), fMax);
+		if (fLeft <= fRight)
+			PushNode(fLeft, fRight, y + nDir, nRoot);
+	}
+
+	void PushNode(const double fLeft, const double fRight, const int nRow, const unsigned int nRoot)
+	{
+		const stAnyaRootPF& root = m_vecRoots[nRoot];
+
+		stAnyaNodePF node;
+		node.fLeft = fLeft;
+		node.fRight = fRight;
+		node.nRow = nRow;
+		node.nRoot = nRoot;
+
+		if (nRow == m_nTargetY && m_nTargetX >= fLeft - ANYA_EPSILON && m_nTargetX <= fRight + ANYA_EPSILON)
+		{
+			node.bGoal = true;
+			node.fScore = root.fCost + Distance(root.nX, root.nY, m_nTargetX, m_nTargetY);
+		}
+		else
+		{
+			node.fScore = root.fCost + Heuristic(root, fLeft, fRight, nRow);
+		}
+
+		m_Open.Push(node);
+		StatsPush(NodeCell(node), m_Open.Size());
+	}
+
+	/*
+	* Root -> interval -> target, the target mirrored when it is on the root
+	* side of the line : the cost from the root through the best interval point
+	*/
+	double Heuristic(const stAnyaRootPF& root, const double fLeft, const double fRight, const int nRow) const noexcept
+	{
+		double fTargetY = m_nTargetY;
+		if (double(root.nY - nRow) * (fTargetY - nRow) > 0)
+			fTargetY = 2.0 * nRow - fTargetY;
+
+		double fCross;
+		if (std::fabs(fTargetY - root.nY) < ANYA_EPSILON)
+			fCross = 0.5 * (root.nX + m_nTargetX);
+		else
+			fCross = root.nX + (m_nTargetX - root.nX) * (nRow - root.nY) / (fTargetY - root.nY);
+
+		fCross = std::min(std::max(fCross, fLeft), fRight);
+
+		return Distance(root.nX, root.nY, fCross, nRow) + Distance(fCross, nRow, m_nTargetX, fTargetY);
+	}
+
+	static double Distance(const double x0, const double y0, const double x1, const double y1) noexcept
+	{
+		return std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+	}
+
+	/* Root of the corner (x, y) reached from nPrev, ANYA_NONE if the corner already has one as cheap */
+	unsigned int AddRoot(const int x, const int y, const unsigned int nPrev)
+	{
+		// corners are board vertices (even half cell coordinates)
+		if ((x | y) & 1)
+			return ANYA_NONE;
+
+		const stAnyaRootPF& prev = m_vecRoots[nPrev];
+		double fCost = prev.fCost + Distance(prev.nX, prev.nY, x, y);
+
+		stAnyaVertexPF& vertex = m_Vertices.Get(size_t(x >> 1) + size_t(y >> 1) * (m_nCols + 1));
+		if (fCost >= vertex.fCost - ANYA_EPSILON)
+		{
+			// same corner from the same root : same search state
+			if (fCost <= vertex.fCost + ANYA_EPSILON && m_vecRoots[vertex.nRoot].nPrev == nPrev)
+				return vertex.nRoot;
+
+			return ANYA_NONE;
+		}
+
+		vertex.fCost = fCost;
+		vertex.nRoot = (unsigned int)m_vecRoots.size();
+		m_vecRoots.push_back({ x, y, fCost, nPrev });
+
+		return vertex.nRoot;
+	}
+
+	bool IsStale(const unsigned int nRoot) const noexcept
+	{
+		if (nRoot == 0)
+			return false;
+
+		const stAnyaRootPF& root = m_vecRoots[nRoot];
+		const stAnyaVertexPF& vertex = m_Vertices[size_t(root.nX >> 1) + size_t(root.nY >> 1) * (m_nCols + 1)];
+
+		return vertex.fCost < root.fCost - ANYA_EPSILON;
+	}
+
+	void MakePath(const unsigned int nRoot, std::vector<stAnyaPointPF>& vecPoints) const
+	{
+		vecPoints.clear();
+		vecPoints.push_back({ m_nTargetX * 0.5f, m_nTargetY * 0.5f });
+
+		for (unsigned int n = nRoot; n != ANYA_NONE; n = m_vecRoots[n].nPrev)
+			vecPoints.push_back({ m_vecRoots[n].nX * 0.5f, m_vecRoots[n].nY * 0.5f });
+
+		std::reverse(vecPoints.begin(), vecPoints.end());
+	}
+
+	/* Free cell across the corner (x, y) from its blocked cell */
+	stCellPF* CornerCell(const int x, const int y) const
+	{
+		static const int arCell[4][2] = { { -1, -1 }, { 0, -1 }, { -1, 0 }, { 0, 0 } };
+
+		for (int i = 0; i < 4; i++)
+		{
+			int nOpposite = 3 - i;
+			if (IsBlockedCell(x + arCell[i][0], y + arCell[i][1]) &&
+				!IsBlockedCell(x + arCell[nOpposite][0], y + arCell[nOpposite][1]))
+				return m_pGridBoard->Get(x + arCell[nOpposite][0], y + arCell[nOpposite][1]);
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (!IsBlockedCell(x + arCell[i][0], y + arCell[i][1]))
+				return m_pGridBoard->Get(x + arCell[i][0], y + arCell[i][1]);
+		}
+
+		return nullptr;
+	}
+
+	/* Board cell under the left end of a node (search events) */
+	stCellPF* NodeCell(const stAnyaNodePF& node) const
+	{
+		int x = std::min(std::max(int(node.fLeft) >> 1, 0), m_nCols - 1);
+		int y = std::min(std::max(node.nRow >> 1, 0), m_nRows - 1);
+
+		return m_pGridBoard->Get(x, y);
+	}
+
+protected:
+	std::vector<stAnyaPointPF>		m_vecPoints;
+	float							m_fCost{ 0.f };
+
+	// board (rebuilt on a grid version change)
+	GridPF*							m_pGridBoard{ nullptr };
+	GridPF*							m_pBoardBuilt{ nullptr };
+	unsigned int					m_nBoardVersion{ 0 };
+	int								m_nCols{ 0 };
+	int								m_nRows{ 0 };
+	std::vector<uint8_t>			m_vecBlocked;
+	std::vector<int>				m_vecRunBegin;
+	std::vector<int>				m_vecRunEnd;
+
+	// search
+	int								m_nTargetX{ 0 };
+	int								m_nTargetY{ 0 };
+	std::vector<stAnyaRootPF>		m_vecRoots;
+	SearchRecords<stAnyaVertexPF>	m_Vertices;
+	SearchOpenList<stAnyaNodePF>	m_Open;
+};
+
+#endif // !XANYA_H
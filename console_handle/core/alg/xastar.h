@@ -11,14 +11,13 @@
 #ifndef XASTAR_H
 #define XASTAR_H
 
-#include <set>
-#include <unordered_map>
-#include <queue>
+#include <vector>
 #include <algorithm> 
 #include <Windows.h>
 #include "xpathfinder.h"
-
-typedef void (*pFunAstarPerform)(std::set<stCellPF*>&, stCellPF*);
+#include "xgridclearance.h"
+#include "xgridmovemask.h"
+#include "xgoalbounds.h"
 
 class AStar : public PathFinding
 {
@@ -38,6 +37,8 @@ protected:
 		float			fDistanceDst{ 0 };
 		_stAStarCellPF* pPrev{ nullptr };
 		stCellPF*		pGrid{ nullptr };
+		unsigned int	nGeneration{ 0 };	// query owning the node data
+		bool			bOpened{ false };
 
 	} stAStarCellPF;
 
@@ -55,10 +56,12 @@ protected:
 		}
 	}stAStarCellPFCompare;
 
-	typedef std::set<stCellPF*> GridPFUniqueManager;
-	typedef std::set<stAStarCellPF*> AstarUniqueManager;
-	typedef std::unordered_map<stCellPF*, stAStarCellPF> AstarMappingData;
-	typedef std::priority_queue<stAStarCellPF*, std::vector<stAStarCellPF*>, stAStarCellPFCompare> AstarCellPriorityQueue;
+	/*
+	* Node pool indexed like the grid cells and binary heap kept as a vector :
+	* both are reused between queries so a warmed up search does not allocate
+	*/
+	typedef std::vector<stAStarCellPF> AstarCellPool;
+	typedef std::vector<stAStarCellPF*> AstarCellPriorityQueue;
 
 	static const int m_nWayDirection = 8;
 
@@ -95,9 +98,39 @@ public:
 		{ 1,  1, 0.f}, // 7	: RightDown
 	};
 
-	virtual void SetFuncPerform(pFunAstarPerform fun) noexcept
+	/*
+	* Clearance map used when the agent radius option is set
+	*/
+	virtual void SetClearance(const GridPFClearance* pClearance) noexcept
+	{
+		m_pClearance = pClearance;
+	}
+
+	/*
+	* Precomputed legal moves, used when built on the searched grid for the
+	* same corner option and no agent radius is set
+	*/
+	virtual void SetMoveMask(const GridPFMoveMask* pMoveMask) noexcept
 	{
-		m_pFunPerform = fun;
+		m_pMoveMask = pMoveMask;
+	}
+
+	/*
+	* Goal bounding boxes, moves leading away from the target are skipped.
+	* Used when built on the searched grid (same version) for the same moves
+	*/
+	virtual void SetGoalBounds(const GoalBounds* pGoalBounds) noexcept
+	{
+		m_pGoalBounds = pGoalBounds;
+	}
+
+	/*
+	* Extra cost added when entering a cell, Cols() x Rows() values >= 0 on
+	* the searched grid (null : none). Goal bounds are not used with it
+	*/
+	virtual void SetCellPenalty(const float* pCellPenalty) noexcept
+	{
+		m_pCellPenalty = pCellPenalty;
 	}
 
 protected:
@@ -173,14 +206,14 @@ protected:
 		if (m_CellPriorityQueue.empty())
 			return nullptr;
 
-		stAStarCellPF* pAstarCellCur = m_CellPriorityQueue.top();
+		stAStarCellPF* pAstarCellCur = m_CellPriorityQueue.front();
 		if (pAstarCellCur->pGrid == nullptr)
 			return nullptr;
 
-		m_CellPriorityQueue.pop();
+		std::pop_heap(m_CellPriorityQueue.begin(), m_CellPriorityQueue.end(), stAStarCellPFCompare());
+		m_CellPriorityQueue.pop_back();
 
-		if (m_pFunPerform)
-			m_GridCellUniqueManager.erase(pAstarCellCur->pGrid);
+		StatsPop(pAstarCellCur->pGrid);
 
 		return pAstarCellCur;
 	}
@@ -193,18 +226,16 @@ protected:
 		if (pCell == nullptr)
 			return false;
 
-		auto itFond = m_CellUniqueManager.find(pCell);
-
-		if (itFond == m_CellUniqueManager.end())
+		if (!pCell->bOpened)
 		{
 			pCell->fDistanceSrc = fDisSrcToCell;
 			pCell->fDistanceDst = fDisCell2Dest;
 			pCell->pPrev = pParent;
-			m_CellPriorityQueue.push(pCell);
-			m_CellUniqueManager.insert(pCell);
+			pCell->bOpened = true;
+			m_CellPriorityQueue.push_back(pCell);
+			std::push_heap(m_CellPriorityQueue.begin(), m_CellPriorityQueue.end(), stAStarCellPFCompare());
 
-			if (m_pFunPerform)
-				m_GridCellUniqueManager.insert(pCell->pGrid);
+			StatsPush(pCell->pGrid, m_CellPriorityQueue.size());
 
 			return true;
 		}
@@ -217,6 +248,8 @@ protected:
 
 				pCell->pPrev = pParent;
 
+				StatsDecreaseKey(pCell->pGrid);
+
 				return true;
 			}
 		}
@@ -229,7 +262,7 @@ protected:
 		std::vector<stCellPF*> path;
 		path.reserve(100);
 
-		size_t szMaxPath = m_GridDataMapping.size();
+		size_t szMaxPath = (size_t)m_nIdxPriority;
 
 		if (pCell == nullptr)
 			return path;
@@ -249,6 +282,40 @@ protected:
 		return path;
 	}
 
+	/*
+	* Write the path into a caller buffer, return the full path length (the
+	* buffer only receives the path when it is large enough)
+	*/
+	virtual size_t GetPath(stAStarCellPF* pCell, stCellPF** pBuffer, size_t szCapacity)
+	{
+		if (pCell == nullptr)
+			return 0;
+
+		size_t szMaxPath = (size_t)m_nIdxPriority;
+		size_t szLength = 0;
+
+		stAStarCellPF* pAstarGridCellCur = pCell;
+
+		do {
+			szLength++;
+			pAstarGridCellCur = pAstarGridCellCur->pPrev;
+
+		} while (pAstarGridCellCur != nullptr && szLength <= szMaxPath);
+
+		if (!pBuffer || szLength > szCapacity)
+			return szLength;
+
+		pAstarGridCellCur = pCell;
+
+		for (size_t i = szLength; i > 0; i--)
+		{
+			pBuffer[i - 1] = pAstarGridCellCur->pGrid;
+			pAstarGridCellCur = pAstarGridCellCur->pPrev;
+		}
+
+		return szLength;
+	}
+
 	virtual float GetDistance(stAStarCellPF* pC1, stAStarCellPF* pC2)
 	{
 		if (!pC1 || !pC2) return -1;
@@ -269,7 +336,12 @@ protected:
 			return false;
 
 		if (_pCell->pGrid && _pCell->pGrid->stData.fWeight <= 0)
+		{
+			if (m_bClearance)
+				return m_pClearance->IsClear(_pCell->pGrid->stIdx.nX, _pCell->pGrid->stIdx.nY, m_fAgentRadius);
+
 			return true;
+		}
 
 		return false;
 	}
@@ -303,7 +375,14 @@ protected:
 
 	virtual bool IsCellMoveableTo(stAStarCellPF* _pCellCur, stAStarCellPF* _pCellNext)
 	{
-		if (!_pCellNext || _pCellNext->pGrid->stData.fWeight > 0)
+		if (m_bMoveMask)
+		{
+			return m_pMoveMask->CanMove(_pCellCur->pGrid->stIdx.nX, _pCellCur->pGrid->stIdx.nY,
+										_pCellNext->pGrid->stIdx.nX - _pCellCur->pGrid->stIdx.nX,
+										_pCellNext->pGrid->stIdx.nY - _pCellCur->pGrid->stIdx.nY);
+		}
+
+		if (!IsCellMoveable(_pCellNext))
 			return false;
 
 		if (IsCrossCell(_pCellCur->pGrid->stIdx, _pCellNext->pGrid->stIdx))
@@ -352,9 +431,14 @@ protected:
 		if (pCell == nullptr)
 			return nullptr;
 
-		stAStarCellPF* pAstarData = &m_GridDataMapping[pCell];
-		if (!pAstarData->pGrid)
+		stAStarCellPF* pAstarData = &m_CellPool[m_pGridBoard->IndexOf(pCell)];
+		if (pAstarData->nGeneration != m_nGeneration)
 		{
+			pAstarData->nGeneration = m_nGeneration;
+			pAstarData->fDistanceSrc = 0.f;
+			pAstarData->fDistanceDst = 0.f;
+			pAstarData->pPrev = nullptr;
+			pAstarData->bOpened = false;
 			pAstarData->pGrid = pCell;
 			pAstarData->nIdx = m_nIdxPriority++;
 		}
@@ -370,10 +454,21 @@ protected:
 		if (m_pGridBoard == nullptr)
 			return false;
 
-		m_GridDataMapping.reserve(m_pGridBoard->Size());
+		if (m_CellPool.size() != m_pGridBoard->Length())
+		{
+			m_CellPool.assign(m_pGridBoard->Length(), stAStarCellPF());
+			m_nGeneration = 0;
+		}
 
 		Reset();
 
+		m_fAgentRadius = pRefOption->m_fAgentRadius;
+		m_bClearance = m_fAgentRadius > 0.f && m_pClearance && m_pClearance->Grid() == m_pGridBoard;
+		m_bMoveMask = !m_bClearance && m_pMoveMask && m_pMoveMask->Grid() == m_pGridBoard &&
+					  m_pMoveMask->DontCrossCorners() == pRefOption->m_bDontCrossCorners;
+		m_bGoalBounds = !m_bClearance && !m_pCellPenalty && m_pGoalBounds && m_pGoalBounds->IsValid(m_pGridBoard) &&
+						m_pGoalBounds->IsFor(pRefOption->m_bAllowCross, pRefOption->m_bDontCrossCorners);
+
 		InitWayDirection(pRefOption->m_bAllowCross ? WayDirectionMode::Eight : WayDirectionMode::Four);
 
 		return true;
@@ -381,90 +476,211 @@ protected:
 
 	virtual void Reset()
 	{
-		m_CellPriorityQueue = AstarCellPriorityQueue();
-		m_GridCellUniqueManager.clear();
-		m_CellUniqueManager.clear();
-		m_GridDataMapping.clear();
+		m_CellPriorityQueue.clear();
 		m_nIdxPriority = 0;
+
+		// Invalidate all pool nodes at once
+		if (++m_nGeneration == 0)
+		{
+			std::fill(m_CellPool.begin(), m_CellPool.end(), stAStarCellPF());
+			m_nGeneration = 1;
+		}
 	}
 
 	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
 	{
-		stAStarCellPF* pCellCur, *pNextCell, *pCellStart, *pCellTarget;
-		float fDisNext2Dest, fDisTraveled = 0.f;
-		std::vector<stCellPF*> path;
+		if (!SearchBegin(pGridBoard, start, target))
+			return std::vector<stCellPF*>();
 
-		stCellIdxPF stIdx;
+		while (SearchStep(m_nSearchMaxStep + 1) > 0);
+
+		return SearchPath();
+	}
+
+protected: // Step-wise search
+
+	virtual bool SearchBegin(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		m_eSearchState = SearchNotFound;
+		m_nSearchExpanded = 0;
 
 		if (!Prepar(pGridBoard))
-			return path;
+			return false;
 
-		pCellCur = pCellStart = GetCell(start);
-		pCellTarget = GetCell(target);
+		StatsBegin();
+
+		m_pSearchCur = m_pSearchStart = GetCell(start);
+		m_pSearchTarget = GetCell(target);
+		m_stSearchStart = start;
+		m_stSearchEnd = target;
+
+		if (!m_pSearchStart || !m_pSearchTarget)
+		{
+			StatsEnd();
+			return false;
+		}
 
 		UpdateWayPriority(start, target);
 
-		PushToPriorityQuery(pCellStart, 0.f, 0.f, nullptr);
+		PushToPriorityQuery(m_pSearchStart, 0.f, 0.f, nullptr);
 
-		size_t nLoop = 0, nMaxStep = pGridBoard->Length();
+		m_nSearchLoop = 0;
+		m_nSearchMaxStep = pGridBoard->Length();
+		m_fSearchStartDst = m_fSearchBestDst = GetDistance(m_pSearchStart, m_pSearchTarget);
+		m_eSearchState = SearchRunning;
 
-		while (pCellCur && nLoop++ <= nMaxStep)
+		return true;
+	}
+
+	virtual size_t SearchStep(size_t nMaxExpansions)
+	{
+		size_t nStep = 0;
+
+		while (m_eSearchState == SearchRunning && nStep < nMaxExpansions)
 		{
-			if (pCellCur == pCellTarget)
+			if (!SearchExpand())
+			{
+				m_eSearchState = (m_pSearchCur && m_pSearchCur == m_pSearchTarget) ? SearchFound : SearchNotFound;
+				StatsEnd();
 				break;
+			}
 
-			for (int i = 0; i < m_nWayDirection; i++)
-			{
-				if (m_arWayDirection[i].w > 0.0001)
-				{
-					stIdx.nX = pCellCur->pGrid->stIdx.nX + m_arWayDirection[i].x;
-					stIdx.nY = pCellCur->pGrid->stIdx.nY + m_arWayDirection[i].y;
+			nStep++;
+		}
 
-					pNextCell = GetCell(stIdx);
+		return nStep;
+	}
 
-					if (pNextCell == nullptr)
-						continue;
+	virtual std::vector<stCellPF*> SearchPath()
+	{
+		// get path if exist
+		if (m_eSearchState == SearchFound)
+			return GetPath(m_pSearchTarget);
 
-					fDisTraveled = pCellCur->fDistanceSrc +
-						(IsCrossCell(pCellCur->pGrid->stIdx, stIdx) ? 1.412f : 1.f);
+		return std::vector<stCellPF*>();
+	}
 
-					fDisNext2Dest = (IsCellMoveableTo(pCellCur, pNextCell) && (pCellCur->pPrev != pNextCell)) ?
-						GetDistance(pNextCell, pCellTarget) : -1.f;
+	virtual size_t SearchPath(stCellPF** pBuffer, size_t szCapacity)
+	{
+		if (m_eSearchState == SearchFound)
+			return GetPath(m_pSearchTarget, pBuffer, szCapacity);
 
-					if (fDisNext2Dest >= 0)
-						PushToPriorityQuery(pNextCell, fDisTraveled, fDisNext2Dest, pCellCur);
-				}
-			}
+		return 0;
+	}
 
-			pCellCur = PopCellPriorityQuery();
+	virtual void SearchProgress(stSearchProgressPF& progress)
+	{
+		progress.nExpanded = m_nSearchExpanded;
+		progress.nOpenSize = m_CellPriorityQueue.size();
+		progress.fProgress = (m_eSearchState == SearchFound) ? 1.f :
+			(m_fSearchStartDst > 0.f ? 1.f - m_fSearchBestDst / m_fSearchStartDst : 0.f);
+	}
 
-			if (m_pFunPerform)
-			{
-				m_pFunPerform(m_GridCellUniqueManager, pCellCur->pGrid);
-			}
+	/*
+	* Expand current cell then pop the next one. Return false when the search ends
+	*/
+	virtual bool SearchExpand()
+	{
+		stAStarCellPF* pCellCur = m_pSearchCur;
 
-			UpdateWayPriority(pCellCur->pGrid->stIdx, target);
-		}
+		if (!pCellCur || m_nSearchLoop++ > m_nSearchMaxStep)
+			return false;
 
-		// get path if exist
-		if (pCellCur == pCellTarget)
+		if (pCellCur == m_pSearchTarget)
+			return false;
+
+		ExpandCell(pCellCur, m_pSearchTarget);
+
+		m_pSearchCur = pCellCur = PopCellPriorityQuery();
+		m_nSearchExpanded++;
+
+		if (pCellCur == nullptr)
+			return false;
+
+		if (pCellCur != m_pSearchStart)
+			m_fSearchBestDst = std::min(m_fSearchBestDst, pCellCur->fDistanceDst);
+
+		UpdateWayPriority(pCellCur->pGrid->stIdx, m_stSearchEnd);
+
+		return true;
+	}
+
+	virtual void ExpandCell(stAStarCellPF* pCellCur, stAStarCellPF* pCellTarget)
+	{
+		stAStarCellPF* pNextCell;
+		float fDisNext2Dest, fDisTraveled = 0.f;
+
+		stCellIdxPF stIdx;
+
+		// legal moves of the cell, the blocked neighbors are not fetched
+		uint8_t nMoves = m_bMoveMask ? m_pMoveMask->Get(pCellCur->pGrid->stIdx.nX, pCellCur->pGrid->stIdx.nY) : 0xFF;
+
+		if (m_bGoalBounds)
+			nMoves &= m_pGoalBounds->Moves(pCellCur->pGrid->stIdx.nX, pCellCur->pGrid->stIdx.nY,
+										   pCellTarget->pGrid->stIdx.nX, pCellTarget->pGrid->stIdx.nY);
+
+		for (int i = 0; i < m_nWayDirection; i++)
 		{
-			path = GetPath(pCellTarget);
-		}
+			if (m_arWayDirection[i].w > 0.0001 &&
+				(nMoves & GridPFMoveMask::Bit(m_arWayDirection[i].x, m_arWayDirection[i].y)))
+			{
+				stIdx.nX = pCellCur->pGrid->stIdx.nX + m_arWayDirection[i].x;
+				stIdx.nY = pCellCur->pGrid->stIdx.nY + m_arWayDirection[i].y;
 
-		return path;
+				pNextCell = GetCell(stIdx);
+
+				if (pNextCell == nullptr)
+					continue;
+
+				fDisTraveled = pCellCur->fDistanceSrc +
+					(IsCrossCell(pCellCur->pGrid->stIdx, stIdx) ? 1.412f : 1.f);
+
+				if (m_pCellPenalty)
+					fDisTraveled += m_pCellPenalty[stIdx.nX + size_t(stIdx.nY) * m_pGridBoard->Cols()];
+
+				fDisNext2Dest = (IsCellMoveableTo(pCellCur, pNextCell) && (pCellCur->pPrev != pNextCell)) ?
+					GetDistance(pNextCell, pCellTarget) : -1.f;
+
+				if (fDisNext2Dest >= 0)
+				{
+					if (PushToPriorityQuery(pNextCell, fDisTraveled, fDisNext2Dest, pCellCur))
+						OnCellPushed(pNextCell);
+				}
+			}
+		}
 	}
 
+	/*
+	* Called when a cell is opened or its cost is improved
+	*/
+	virtual void OnCellPushed(stAStarCellPF* /*pCell*/) { }
+
 protected:// internal
 	AstarCellPriorityQueue		m_CellPriorityQueue;
-	AstarUniqueManager			m_CellUniqueManager;
-	AstarMappingData			m_GridDataMapping;
+	AstarCellPool				m_CellPool;
+	unsigned int				m_nGeneration = 0;
 	int							m_nIdxPriority = 0;
 
+protected:// search state
+	stAStarCellPF*				m_pSearchCur{nullptr};
+	stAStarCellPF*				m_pSearchStart{nullptr};
+	stAStarCellPF*				m_pSearchTarget{nullptr};
+	size_t						m_nSearchLoop{0};
+	size_t						m_nSearchMaxStep{0};
+	size_t						m_nSearchExpanded{0};
+	float						m_fSearchStartDst{0.f};
+	float						m_fSearchBestDst{0.f};
+
 protected:// setup
-	GridPFUniqueManager			m_GridCellUniqueManager;
-	pFunAstarPerform			m_pFunPerform{nullptr};
 	GridPF*						m_pGridBoard{nullptr};
+	const GridPFClearance*		m_pClearance{nullptr};
+	const GridPFMoveMask*		m_pMoveMask{nullptr};
+	const GoalBounds*			m_pGoalBounds{nullptr};
+	const float*				m_pCellPenalty{nullptr};
+	float						m_fAgentRadius{0.f};
+	bool						m_bClearance{false};
+	bool						m_bMoveMask{false};
+	bool						m_bGoalBounds{false};
 };
 
 
@@ -0,0 +1,910 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Contraction hierarchy over the grid graph (static maps, long queries)
+* @file  : xcontraction.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XCONTRACTION_H
+#define XCONTRACTION_H
+
+#include <stdio.h>
+#include <share.h>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define CH_NONE				UINT32_MAX
+#define CH_MAGIC			0x46504843u		// 'CHPF'
+#define CH_VERSION			1u
+#define CH_WITNESS_SETTLE	500				// settled nodes per witness search
+#define CH_EPSILON			1e-4f
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stCHEdge
+{
+	uint32_t nTo{ CH_NONE };
+	uint32_t nMid{ CH_NONE };		// contracted node of a shortcut, CH_NONE : grid move
+	float	 fCost{ 0.f };
+} stCHEdgePF;
+
+typedef struct _stCHHeader
+{
+	uint32_t nMagic{ CH_MAGIC };
+	uint32_t nVersion{ CH_VERSION };
+	uint32_t nCols{ 0 };
+	uint32_t nRows{ 0 };
+	uint64_t nBoardHash{ 0 };
+	uint32_t nFlags{ 0 };			// bit 0 : cross, bit 1 : dont cross corners
+	uint32_t nNodes{ 0 };
+	uint32_t nEdges{ 0 };
+} stCHHeaderPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// ContractionHierarchy class
+
+/*
+* Nodes are the free cells, edges the a-star moves (1 / 1.412). Nodes are
+* contracted by rounds : every round takes the nodes whose priority (edge
+* difference + contracted neighbors) is lower than all their neighbors, an
+* independent set, and contracts them on all threads. Priorities are only
+* refreshed for those candidates whose neighborhood changed (lazy update).
+* Query : bidirectional upward Dijkstra with stall on demand.
+* Storage : upward edges only, 12 bytes per edge + 8 bytes per node + 4 bytes
+* per cell.
+*/
+class ContractionHierarchy
+{
+	typedef struct _stWitnessNode
+	{
+		uint32_t	nGeneration{ 0 };
+		bool		bTarget{ false };	// neighbor still to settle
+		float		fDist{ -1.f };		// < 0 : not reached
+	} stWitnessNodePF;
+
+	typedef struct _stWitnessScratch
+	{
+		SearchRecords<stWitnessNodePF>					Records;
+		SearchOpenList<std::pair<float, uint32_t>>		Open;
+		std::vector<stCHEdgePF>							vecShortcut;	// nTo : from, nMid : to
+	} stWitnessScratchPF;
+
+public:
+	/* nThreads 0 : all hardware threads */
+	bool Build(GridPF* pGridBoard, const bool bAllowCross = true, const bool bDontCrossCorners = false,
+			   const unsigned int nThreads = 0)
+	{
+		Clear();
+
+		if (!pGridBoard || pGridBoard->Length() == 0)
+			return false;
+
+		m_bAllowCross = bAllowCross;
+		m_bDontCrossCorners = bDontCrossCorners;
+
+		ReadBoard(pGridBoard);
+
+		unsigned int nWorkers = util::thread_count(nThreads);
+		uint32_t nCount = (uint32_t)m_vecNodeCell.size();
+
+		// Working graph (both directions)
+		std::vector<std::vector<stCHEdgePF>> vecAdj(nCount);
+		MakeGridEdges(vecAdj);
+
+		std::vector<stWitnessScratchPF> vecScratch(nWorkers);
+
+		std::vector<int>		vecEdgeDiff(nCount, 0);
+		std::vector<int>		vecDeleted(nCount, 0);
+		std::vector<uint8_t>	vecContracted(nCount, 0);
+		std::vector<uint8_t>	vecDirty(nCount, 0);
+		std::vector<uint8_t>	vecInSet(nCount, 0);
+		std::vector<uint32_t>	vecRemain(nCount);
+		std::vector<uint32_t>	vecCandidate;
+		std::vector<uint32_t>	vecSet;
+		std::vector<std::vector<stCHEdgePF>> vecShortcuts;
+
+		for (uint32_t i = 0; i < nCount; i++)
+			vecRemain[i] = i;
+
+		// Priority : edge difference + contracted neighbors
+		auto IsLocalMin = [&](const uint32_t v)
+		{
+			int nPriority = vecEdgeDiff[v] + vecDeleted[v];
+			for (auto& edge : vecAdj[v])
+			{
+				uint32_t u = edge.nTo;
+				int nOther = vecEdgeDiff[u] + vecDeleted[u];
+				if (nOther < nPriority || (nOther == nPriority && TieOrder(u) < TieOrder(v)))
+					return false;
+			}
+			return true;
+		};
+
+		// Initial priorities
+		util::parallel_for(0, vecRemain.size(), [&](size_t nBegin, size_t nEnd, unsigned int t)
+		{
+			for (size_t i = nBegin; i < nEnd; i++)
+			{
+				Contract(vecAdj, vecRemain[i], nullptr, vecScratch[t]);
+				vecEdgeDiff[i] = int(vecScratch[t].vecShortcut.size()) - int(vecAdj[i].size());
+			}
+		}, nWorkers);
+
+		while (!vecRemain.empty())
+		{
+			// Local minima on the last known priorities (independent set)
+			vecCandidate.clear();
+			for (uint32_t v : vecRemain)
+			{
+				if (IsLocalMin(v))
+					vecCandidate.push_back(v);
+			}
+
+			// Shortcuts of the candidates (read only on the graph). Witnesses avoid all
+			// of them so that any subset can be contracted at once. Also refreshes the
+			// priority of the candidates whose neighborhood changed
+			for (uint32_t v : vecCandidate)
+				vecInSet[v] = 1;
+
+			vecShortcuts.resize(vecCandidate.size());
+			util::parallel_for(0, vecCandidate.size(), [&](size_t nBegin, size_t nEnd, unsigned int t)
+			{
+				for (size_t i = nBegin; i < nEnd; i++)
+				{
+					uint32_t v = vecCandidate[i];
+
+					Contract(vecAdj, v, &vecInSet, vecScratch[t]);
+					vecShortcuts[i] = vecScratch[t].vecShortcut;
+
+					if (vecDirty[v])
+					{
+						vecEdgeDiff[v] = int(vecShortcuts[i].size()) - int(vecAdj[v].size());
+						vecDirty[v] = 0;
+					}
+				}
+			}, nWorkers);
+
+			// Keep those still minimal after the refresh
+			vecSet.clear();
+			for (size_t i = 0; i < vecCandidate.size(); i++)
+			{
+				if (IsLocalMin(vecCandidate[i]))
+					vecSet.push_back(uint32_t(i));
+			}
+
+			if (vecSet.empty())
+			{
+				for (size_t i = 0; i < vecCandidate.size(); i++)
+					vecSet.push_back(uint32_t(i));
+			}
+
+			for (uint32_t v : vecCandidate)
+				vecInSet[v] = 0;
+
+			for (uint32_t i : vecSet)
+			{
+				uint32_t v = vecCandidate[i];
+				vecContracted[v] = 1;
+
+				// The remaining neighbors are the upward edges of v
+				for (auto& edge : vecAdj[v])
+				{
+					RemoveEdge(vecAdj[edge.nTo], v);
+					vecDeleted[edge.nTo]++;
+					vecDirty[edge.nTo] = 1;
+				}
+
+				for (auto& sc : vecShortcuts[i])
+				{
+					AddEdge(vecAdj[sc.nTo], sc.nMid, v, sc.fCost);
+					AddEdge(vecAdj[sc.nMid], sc.nTo, v, sc.fCost);
+				}
+			}
+
+			vecRemain.erase(std::remove_if(vecRemain.begin(), vecRemain.end(),
+				[&](uint32_t v) { return vecContracted[v] != 0; }), vecRemain.end());
+		}
+
+		// Upward graph
+		m_vecOffsets.assign(size_t(nCount) + 1, 0);
+		for (uint32_t v = 0; v < nCount; v++)
+			m_vecOffsets[v + 1] = m_vecOffsets[v] + (uint32_t)vecAdj[v].size();
+
+		m_vecEdges.resize(m_vecOffsets[nCount]);
+		for (uint32_t v = 0; v < nCount; v++)
+		{
+			std::copy(vecAdj[v].begin(), vecAdj[v].end(), m_vecEdges.begin() + m_vecOffsets[v]);
+			std::vector<stCHEdgePF>().swap(vecAdj[v]);
+		}
+
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = 0;
+		m_nBoardHash = 0;
+		m_vecCellNode.clear();
+		m_vecNodeCell.clear();
+		m_vecOffsets.clear();
+		m_vecEdges.clear();
+	}
+
+public:
+	bool IsValid(GridPF* pGridBoard) const noexcept
+	{
+		return pGridBoard && m_pGridBoard == pGridBoard && m_nGridVersion == pGridBoard->Version();
+	}
+
+	bool IsSameMove(const bool bAllowCross, const bool bDontCrossCorners) const noexcept
+	{
+		return m_bAllowCross == bAllowCross && (!bAllowCross || m_bDontCrossCorners == bDontCrossCorners);
+	}
+
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	size_t NodeCount() const noexcept { return m_vecNodeCell.size(); }
+	size_t EdgeCount() const noexcept { return m_vecEdges.size(); }
+	size_t MemorySize() const noexcept
+	{
+		return m_vecEdges.size() * sizeof(stCHEdgePF) + m_vecOffsets.size() * sizeof(uint32_t) +
+			   m_vecNodeCell.size() * sizeof(uint32_t) + m_vecCellNode.size() * sizeof(uint32_t);
+	}
+
+	/* CH_NONE for obstacles */
+	uint32_t NodeAt(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return CH_NONE;
+
+		return m_vecCellNode[x + size_t(y) * m_nCols];
+	}
+
+	stCellIdxPF NodeIdx(const uint32_t nNode) const noexcept
+	{
+		uint32_t nCell = m_vecNodeCell[nNode];
+		return { int(nCell % uint32_t(m_nCols)), int(nCell / uint32_t(m_nCols)) };
+	}
+
+	const stCHEdgePF* UpBegin(const uint32_t nNode) const noexcept { return m_vecEdges.data() + m_vecOffsets[nNode]; }
+	const stCHEdgePF* UpEnd(const uint32_t nNode) const noexcept { return m_vecEdges.data() + m_vecOffsets[nNode + 1]; }
+
+	/* Edge between two nodes, stored on the lower one */
+	const stCHEdgePF* FindEdge(const uint32_t a, const uint32_t b) const noexcept
+	{
+		for (const stCHEdgePF* p = UpBegin(a); p != UpEnd(a); p++)
+		{
+			if (p->nTo == b)
+				return p;
+		}
+
+		for (const stCHEdgePF* p = UpBegin(b); p != UpEnd(b); p++)
+		{
+			if (p->nTo == a)
+				return p;
+		}
+
+		return nullptr;
+	}
+
+public: // Serialize
+	bool Save(const wchar_t* path) const
+	{
+		FILE* file = _wfsopen(path, L"wb", _SH_DENYWR);
+		if (!file) return false;
+
+		bool bRet = Save(file);
+		fclose(file);
+
+		return bRet;
+	}
+
+	bool Save(FILE* file) const
+	{
+		if (!file || m_vecOffsets.empty())
+			return false;
+
+		stCHHeaderPF stHeader;
+		stHeader.nCols = m_nCols;
+		stHeader.nRows = m_nRows;
+		stHeader.nBoardHash = m_nBoardHash;
+		stHeader.nFlags = (m_bAllowCross ? 1u : 0u) | (m_bDontCrossCorners ? 2u : 0u);
+		stHeader.nNodes = (uint32_t)m_vecNodeCell.size();
+		stHeader.nEdges = (uint32_t)m_vecEdges.size();
+
+		return fwrite(&stHeader, sizeof(stHeader), 1, file) == 1 &&
+			   WriteArray(file, m_vecOffsets) && WriteArray(file, m_vecEdges);
+	}
+
+	/* Hierarchy must have been built from the same obstacles as the board */
+	bool Load(GridPF* pGridBoard, const wchar_t* path)
+	{
+		FILE* file = _wfsopen(path, L"rb", _SH_DENYWR);
+		if (!file) return false;
+
+		bool bRet = Load(pGridBoard, file);
+		fclose(file);
+
+		return bRet;
+	}
+
+	bool Load(GridPF* pGridBoard, FILE* file)
+	{
+		Clear();
+
+		if (!pGridBoard || !file)
+			return false;
+
+		stCHHeaderPF stHeader;
+		if (fread(&stHeader, sizeof(stHeader), 1, file) != 1 ||
+			stHeader.nMagic != CH_MAGIC || stHeader.nVersion != CH_VERSION)
+			return false;
+
+		ReadBoard(pGridBoard);
+
+		if (stHeader.nCols != (uint32_t)m_nCols || stHeader.nRows != (uint32_t)m_nRows ||
+			stHeader.nBoardHash != m_nBoardHash || stHeader.nNodes != m_vecNodeCell.size() ||
+			!ReadArray(file, m_vecOffsets, size_t(stHeader.nNodes) + 1) ||
+			!ReadArray(file, m_vecEdges, stHeader.nEdges) || !IsConsistent())
+		{
+			Clear();
+			return false;
+		}
+
+		m_bAllowCross = (stHeader.nFlags & 1u) != 0;
+		m_bDontCrossCorners = (stHeader.nFlags & 2u) != 0;
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+protected:
+	/*
+	* Loaded offsets and edges index inside the arrays, the upward edges have no
+	* cycle and the middle node of a shortcut comes before both its ends in that
+	* order (a shortcut is unpacked in a finite number of steps).
+	*/
+	bool IsConsistent() const
+	{
+		if (m_vecOffsets.empty() || m_vecOffsets.front() != 0 || m_vecOffsets.back() != m_vecEdges.size())
+			return false;
+
+		for (size_t i = 1; i < m_vecOffsets.size(); i++)
+		{
+			if (m_vecOffsets[i] < m_vecOffsets[i - 1])
+				return false;
+		}
+
+		const size_t szNodes = m_vecNodeCell.size();
+
+		for (auto& edge : m_vecEdges)
+		{
+			if (edge.nTo >= szNodes || (edge.nMid != CH_NONE && edge.nMid >= szNodes) || !(edge.fCost >= 0.f))
+				return false;
+		}
+
+		// Contraction order rebuilt from the upward edges (topological order)
+		std::vector<uint32_t> vecIn(szNodes, 0);
+		std::vector<uint32_t> vecRank(szNodes, CH_NONE);
+		std::vector<uint32_t> vecOrder;
+		vecOrder.reserve(szNodes);
+
+		for (auto& edge : m_vecEdges)
+			vecIn[edge.nTo]++;
+
+		for (uint32_t n = 0; n < szNodes; n++)
+		{
+			if (vecIn[n] == 0)
+				vecOrder.push_back(n);
+		}
+
+		for (size_t i = 0; i < vecOrder.size(); i++)
+		{
+			uint32_t n = vecOrder[i];
+			vecRank[n] = uint32_t(i);
+
+			for (const stCHEdgePF* p = UpBegin(n); p != UpEnd(n); p++)
+			{
+				if (--vecIn[p->nTo] == 0)
+					vecOrder.push_back(p->nTo);
+			}
+		}
+
+		if (vecOrder.size() != szNodes)
+			return false;
+
+		for (uint32_t n = 0; n < szNodes; n++)
+		{
+			for (const stCHEdgePF* p = UpBegin(n); p != UpEnd(n); p++)
+			{
+				if (p->nMid != CH_NONE && (vecRank[p->nMid] >= vecRank[n] || vecRank[p->nMid] >= vecRank[p->nTo]))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename _Ty>
+	static bool WriteArray(FILE* file, const std::vector<_Ty>& vec)
+	{
+		return vec.empty() || fwrite(vec.data(), sizeof(_Ty), vec.size(), file) == vec.size();
+	}
+
+	template<typename _Ty>
+	static bool ReadArray(FILE* file, std::vector<_Ty>& vec, const size_t szCount)
+	{
+		vec.resize(szCount);
+		return vec.empty() || fread(vec.data(), sizeof(_Ty), szCount, file) == szCount;
+	}
+
+	/* Free cells become nodes (row order), obstacle hash for the serialization */
+	void ReadBoard(GridPF* pGridBoard)
+	{
+		m_nCols = pGridBoard->Cols();
+		m_nRows = pGridBoard->Rows();
+		m_vecCellNode.assign(size_t(m_nCols) * m_nRows, CH_NONE);
+		m_vecNodeCell.clear();
+
+		uint64_t nHash = 1469598103934665603ull;
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = pGridBoard->Get(x, y);
+				bool bBlocked = (!pCell || pCell->stData.fWeight > 0);
+
+				if (!bBlocked)
+				{
+					m_vecCellNode[x + size_t(y) * m_nCols] = (uint32_t)m_vecNodeCell.size();
+					m_vecNodeCell.push_back(uint32_t(x + size_t(y) * m_nCols));
+				}
+
+				nHash = (nHash ^ (bBlocked ? 1u : 0u)) * 1099511628211ull;
+			}
+		}
+
+		m_nBoardHash = nHash;
+	}
+
+	/* Same move rules as the a-star */
+	void MakeGridEdges(std::vector<std::vector<stCHEdgePF>>& vecAdj) const
+	{
+		for (uint32_t v = 0; v < (uint32_t)m_vecNodeCell.size(); v++)
+		{
+			stCellIdxPF idx = NodeIdx(v);
+
+			for (int dy = -1; dy <= 1; dy++)
+			{
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					if ((dx == 0 && dy == 0) || (!m_bAllowCross && dx != 0 && dy != 0))
+						continue;
+
+					uint32_t u = NodeAt(idx.nX + dx, idx.nY + dy);
+					if (u == CH_NONE)
+						continue;
+
+					if (dx != 0 && dy != 0)
+					{
+						bool bFree1 = NodeAt(idx.nX + dx, idx.nY) != CH_NONE;
+						bool bFree2 = NodeAt(idx.nX, idx.nY + dy) != CH_NONE;
+
+						if (m_bDontCrossCorners ? !(bFree1 && bFree2) : !(bFree1 || bFree2))
+							continue;
+					}
+
+					stCHEdgePF edge;
+					edge.nTo = u;
+					edge.fCost = (dx != 0 && dy != 0) ? 1.412f : 1.f;
+					vecAdj[v].push_back(edge);
+				}
+			}
+		}
+	}
+
+	/* Scrambled id : equal priorities on a grid would otherwise give a tiny set */
+	static uint32_t TieOrder(uint32_t v) noexcept
+	{
+		v ^= v >> 16;
+		v *= 0x7feb352dU;
+		v ^= v >> 15;
+		v *= 0x846ca68bU;
+		v ^= v >> 16;
+		return v;
+	}
+
+	static void RemoveEdge(std::vector<stCHEdgePF>& vecEdges, const uint32_t nTo)
+	{
+		vecEdges.erase(std::remove_if(vecEdges.begin(), vecEdges.end(),
+			[nTo](const stCHEdgePF& edge) { return edge.nTo == nTo; }), vecEdges.end());
+	}
+
+	static void AddEdge(std::vector<stCHEdgePF>& vecEdges, const uint32_t nTo, const uint32_t nMid, const float fCost)
+	{
+		for (auto& edge : vecEdges)
+		{
+			if (edge.nTo == nTo)
+			{
+				if (fCost < edge.fCost)
+				{
+					edge.fCost = fCost;
+					edge.nMid = nMid;
+				}
+				return;
+			}
+		}
+
+		stCHEdgePF edge;
+		edge.nTo = nTo;
+		edge.nMid = nMid;
+		edge.fCost = fCost;
+		vecEdges.push_back(edge);
+	}
+
+	/*
+	* Shortcuts needed to remove v : pairs of neighbors without a witness
+	* path as short avoiding v and pAvoid (result in scratch.vecShortcut)
+	*/
+	void Contract(const std::vector<std::vector<stCHEdgePF>>& vecAdj, const uint32_t v,
+				  const std::vector<uint8_t>* pAvoid, stWitnessScratchPF& scratch) const
+	{
+		scratch.vecShortcut.clear();
+
+		const auto& vecEdges = vecAdj[v];
+		if (vecEdges.size() < 2)
+			return;
+
+		for (size_t i = 0; i + 1 < vecEdges.size(); i++)
+		{
+			uint32_t u = vecEdges[i].nTo;
+
+			Witness(vecAdj, v, i, pAvoid, scratch);
+
+			for (size_t j = i + 1; j < vecEdges.size(); j++)
+			{
+				uint32_t w = vecEdges[j].nTo;
+				float fVia = vecEdges[i].fCost + vecEdges[j].fCost;
+
+				const stWitnessNodePF& node = scratch.Records[w];
+				if (scratch.Records.IsCurrent(w) && node.fDist >= 0.f && node.fDist <= fVia + CH_EPSILON)
+					continue;
+
+				stCHEdgePF sc;
+				sc.nTo = u;
+				sc.nMid = w;
+				sc.fCost = fVia;
+				scratch.vecShortcut.push_back(sc);
+			}
+		}
+	}
+
+	/*
+	* Bounded Dijkstra from the neighbor i of v without v (nor the nodes of pAvoid),
+	* stops once the neighbors after i are settled
+	*/
+	void Witness(const std::vector<std::vector<stCHEdgePF>>& vecAdj, const uint32_t v, const size_t i,
+				 const std::vector<uint8_t>* pAvoid, stWitnessScratchPF& scratch) const
+	{
+		auto& records = scratch.Records;
+		auto& open = scratch.Open;
+
+		records.Begin(vecAdj.size());
+		open.Clear();
+
+		const auto& vecEdges = vecAdj[v];
+		const uint32_t u = vecEdges[i].nTo;
+
+		float fMaxOut = 0.f;
+		size_t szTargets = 0;
+		for (size_t j = i + 1; j < vecEdges.size(); j++)
+		{
+			fMaxOut = std::max(fMaxOut, vecEdges[j].fCost);
+
+			stWitnessNodePF& target = records.Get(vecEdges[j].nTo);
+			if (!target.bTarget)
+			{
+				target.bTarget = true;
+				szTargets++;
+			}
+		}
+
+		const float fBound = vecEdges[i].fCost + fMaxOut;
+
+		records.Get(u).fDist = 0.f;
+		open.Push({ -0.f, u });
+
+		int nSettled = 0;
+		while (!open.Empty() && nSettled < CH_WITNESS_SETTLE)
+		{
+			auto item = open.Pop();
+
+			uint32_t x = item.second;
+			float fDist = -item.first;
+
+			if (fDist > records[x].fDist)
+				continue;
+
+			if (records[x].bTarget && --szTargets == 0)
+				break;
+
+			nSettled++;
+
+			for (auto& edge : vecAdj[x])
+			{
+				if (edge.nTo == v || (pAvoid && (*pAvoid)[edge.nTo]))
+					continue;
+
+				float fNext = fDist + edge.fCost;
+				if (fNext > fBound + CH_EPSILON)
+					continue;
+
+				stWitnessNodePF& next = records.Get(edge.nTo);
+				if (next.fDist >= 0.f && next.fDist <= fNext)
+					continue;
+
+				next.fDist = fNext;
+				open.Push({ -fNext, edge.nTo });
+			}
+		}
+	}
+
+protected:
+	GridPF*					m_pGridBoard{ nullptr };
+	unsigned int			m_nGridVersion{ 0 };
+	bool					m_bAllowCross{ true };
+	bool					m_bDontCrossCorners{ false };
+	int						m_nCols{ 0 };
+	int						m_nRows{ 0 };
+	uint64_t				m_nBoardHash{ 0 };
+
+	std::vector<uint32_t>	m_vecCellNode;	// cell -> node
+	std::vector<uint32_t>	m_vecNodeCell;	// node -> cell
+	std::vector<uint32_t>	m_vecOffsets;
+	std::vector<stCHEdgePF>	m_vecEdges;		// upward edges
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// ContractionHierarchySearch class
+
+/*
+* Bidirectional Dijkstra on the upward edges, the shortcuts of the best
+* meeting are unpacked back into grid moves. One set of records and one
+* open list per direction (0 : from the start, 1 : from the target).
+*/
+class ContractionHierarchySearch : public PathFinding
+{
+	typedef struct _stCHSearchNode
+	{
+		uint32_t	nGeneration{ 0 };
+		uint32_t	nPrev{ CH_NONE };
+		float		fCost{ -1.f };		// < 0 : not reached
+	} stCHSearchNodePF;
+
+	typedef struct _stCHOpen
+	{
+		float		fCost{ 0.f };
+		uint32_t	nNode{ 0 };
+
+		bool operator<(const _stCHOpen& other) const noexcept
+		{
+			return fCost > other.fCost;
+		}
+	} stCHOpenPF;
+
+public:
+	/* External hierarchy (Build or Load first), nullptr : internal one built on demand */
+	void SetHierarchy(ContractionHierarchy* pHierarchy) noexcept
+	{
+		m_pHierarchy = pHierarchy;
+	}
+
+	ContractionHierarchy* GetHierarchy() noexcept
+	{
+		return m_pHierarchy ? m_pHierarchy : &m_Hierarchy;
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		if (!pGridBoard)
+			return path;
+
+		bool bCross = !pRefOption || pRefOption->m_bAllowCross;
+		bool bDontCrossCorners = pRefOption && pRefOption->m_bDontCrossCorners;
+
+		ContractionHierarchy* pCH = m_pHierarchy;
+		if (!pCH || !pCH->IsValid(pGridBoard) || !pCH->IsSameMove(bCross, bDontCrossCorners))
+		{
+			pCH = &m_Hierarchy;
+			if (!pCH->IsValid(pGridBoard) || !pCH->IsSameMove(bCross, bDontCrossCorners))
+				pCH->Build(pGridBoard, bCross, bDontCrossCorners);
+		}
+
+		StatsBegin();
+
+		uint32_t s = pCH->NodeAt(start.nX, start.nY);
+		uint32_t t = pCH->NodeAt(target.nX, target.nY);
+
+		uint32_t nMeet = (s == CH_NONE || t == CH_NONE) ? CH_NONE : Search(pCH, pGridBoard, s, t);
+
+		if (nMeet != CH_NONE)
+			MakePath(pCH, pGridBoard, nMeet, path);
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	/* Meeting node of the shortest path, CH_NONE when not found */
+	uint32_t Search(ContractionHierarchy* pCH, GridPF* pGridBoard, const uint32_t s, const uint32_t t)
+	{
+		const uint32_t nRoot[2] = { s, t };
+		for (int d = 0; d < 2; d++)
+		{
+			m_Records[d].Begin(pCH->NodeCount());
+			m_Open[d].Clear();
+			m_Records[d].Get(nRoot[d]).fCost = 0.f;
+			m_Open[d].Push({ 0.f, nRoot[d] });
+		}
+
+		float fBest = -1.f;
+		uint32_t nMeet = CH_NONE;
+
+		while (!m_Open[0].Empty() || !m_Open[1].Empty())
+		{
+			// Alternate on the direction with the smaller key
+			int d = m_Open[0].Empty() ? 1 :
+					(m_Open[1].Empty() ? 0 : (m_Open[0].Top().fCost <= m_Open[1].Top().fCost ? 0 : 1));
+
+			auto& open = m_Open[d];
+			auto& records = m_Records[d];
+			auto& other = m_Records[1 - d];
+
+			stCHOpenPF stOpen = open.Pop();
+
+			if (fBest >= 0.f && stOpen.fCost >= fBest)
+			{
+				open.Clear();
+				continue;
+			}
+
+			stCHSearchNodePF& rec = records[stOpen.nNode];
+			if (stOpen.fCost > rec.fCost)
+				continue;
+
+			StatsPop(pGridBoard->Get(pCH->NodeIdx(stOpen.nNode)));
+
+			// Stall on demand : a higher neighbor already gives a shorter way to this node,
+			// the node is not on a shortest up-down path
+			bool bStall = false;
+			for (const stCHEdgePF* p = pCH->UpBegin(stOpen.nNode); p != pCH->UpEnd(stOpen.nNode); p++)
+			{
+				if (records.IsCurrent(p->nTo) && records[p->nTo].fCost + p->fCost < stOpen.fCost)
+				{
+					bStall = true;
+					break;
+				}
+			}
+
+			if (bStall)
+				continue;
+
+			if (other.IsCurrent(stOpen.nNode))
+			{
+				float fTotal = rec.fCost + other[stOpen.nNode].fCost;
+				if (fBest < 0.f || fTotal < fBest)
+				{
+					fBest = fTotal;
+					nMeet = stOpen.nNode;
+				}
+			}
+
+			for (const stCHEdgePF* p = pCH->UpBegin(stOpen.nNode); p != pCH->UpEnd(stOpen.nNode); p++)
+			{
+				float fNext = stOpen.fCost + p->fCost;
+				stCHSearchNodePF& next = records.Get(p->nTo);
+
+				if (next.fCost >= 0.f && next.fCost <= fNext)
+					continue;
+
+				next.nPrev = stOpen.nNode;
+				next.fCost = fNext;
+
+				open.Push({ fNext, p->nTo });
+				StatsPush(nullptr, open.Size());
+
+				if (other.IsCurrent(p->nTo))
+				{
+					float fTotal = fNext + other[p->nTo].fCost;
+					if (fBest < 0.f || fTotal < fBest)
+					{
+						fBest = fTotal;
+						nMeet = p->nTo;
+					}
+				}
+			}
+		}
+
+		return nMeet;
+	}
+
+	/* Grid moves of the edge a -> b (shortcuts are unpacked through their middle node) */
+	void Unpack(ContractionHierarchy* pCH, GridPF* pGridBoard, const uint32_t a, const uint32_t b,
+				std::vector<stCellPF*>& path)
+	{
+		m_vecStack.clear();
+		m_vecStack.push_back({ a, b });
+
+		while (!m_vecStack.empty())
+		{
+			auto item = m_vecStack.back();
+			m_vecStack.pop_back();
+
+			const stCHEdgePF* pEdge = pCH->FindEdge(item.first, item.second);
+			if (pEdge && pEdge->nMid != CH_NONE)
+			{
+				// Second half is processed last
+				m_vecStack.push_back({ pEdge->nMid, item.second });
+				m_vecStack.push_back({ item.first, pEdge->nMid });
+				continue;
+			}
+
+			path.push_back(pGridBoard->Get(pCH->NodeIdx(item.second)));
+		}
+	}
+
+	void MakePath(ContractionHierarchy* pCH, GridPF* pGridBoard, const uint32_t nMeet, std::vector<stCellPF*>& path)
+	{
+		// start -> meet
+		m_vecChain.clear();
+		for (uint32_t n = nMeet; n != CH_NONE; n = m_Records[0][n].nPrev)
+			m_vecChain.push_back(n);
+
+		std::reverse(m_vecChain.begin(), m_vecChain.end());
+
+		// meet -> target
+		for (uint32_t n = m_Records[1][nMeet].nPrev; n != CH_NONE; n = m_Records[1][n].nPrev)
+			m_vecChain.push_back(n);
+
+		path.push_back(pGridBoard->Get(pCH->NodeIdx(m_vecChain[0])));
+
+		for (size_t i = 0; i + 1 < m_vecChain.size(); i++)
+			Unpack(pCH, pGridBoard, m_vecChain[i], m_vecChain[i + 1], path);
+	}
+
+protected:
+	ContractionHierarchy*					m_pHierarchy{ nullptr };
+	ContractionHierarchy					m_Hierarchy;
+
+	// search
+	SearchRecords<stCHSearchNodePF>			m_Records[2];
+	SearchOpenList<stCHOpenPF>				m_Open[2];
+	std::vector<uint32_t>					m_vecChain;
+	std::vector<std::pair<uint32_t, uint32_t>> m_vecStack;
+};
+
+#endif // !XCONTRACTION_H
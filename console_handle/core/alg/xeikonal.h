@@ -0,0 +1,441 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Eikonal distance field (fast sweeping) and gradient descent path
+* @file  : xeikonal.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XEIKONAL_H
+#define XEIKONAL_H
+
+#include <vector>
+#include <cmath>
+#include <functional>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "com/xparallel.h"
+
+#define EIKONAL_INF_DISTANCE 1e18f
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stPointPF
+{
+	float fX{ 0.f };	// cell center is at integer coordinates
+	float fY{ 0.f };
+} stPointPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// EikonalSolver class
+
+/*
+* Solve |grad T| = cost on the board with the fast sweeping method, T = 0 at
+* the source. Cells with weight > 0 are obstacles ; the cost of the other cells
+* is 1 unless a cost function is given.
+*
+* Parallel sweeps : rows are visited down then up. Threads own column ranges
+* of every row, so a row is updated at once and the inner loops over x are
+* contiguous and vectorizable.
+*/
+class EikonalSolver
+{
+public:
+	typedef std::function<float(const stCellPF&)> FunCellCost;
+
+public:
+	/* cost > 0 for walkable cells */
+	void SetCostFunction(FunCellCost funCost)
+	{
+		m_funCost = funCost;
+		m_nCostGeneration++;
+	}
+
+	/* Changed by each SetCostFunction, fields solved before are stale */
+	unsigned int CostGeneration() const noexcept
+	{
+		return m_nCostGeneration;
+	}
+
+	void SetThreads(unsigned int nThreads) noexcept
+	{
+		m_nThreads = nThreads;
+	}
+
+	void SetTolerance(float fTolerance, unsigned int nMaxIteration = 0) noexcept
+	{
+		m_fTolerance = fTolerance;
+		m_nMaxIteration = nMaxIteration;
+	}
+
+public:
+	bool Solve(GridPF* pGridBoard, stCellIdxPF source)
+	{
+		m_pGridBoard = pGridBoard;
+		m_nIteration = 0;
+
+		if (!pGridBoard || !pGridBoard->Get(source))
+			return false;
+
+		m_nCols = pGridBoard->Cols();
+		m_nRows = pGridBoard->Rows();
+
+		size_t szLength = pGridBoard->Length();
+		m_vecField.assign(szLength, EIKONAL_INF_DISTANCE);
+		m_vecOld.resize(szLength);
+		m_vecCost.resize(szLength);
+		m_vecMask.resize(szLength);
+		m_vecAxisB.resize(m_nCols);
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				size_t i = size_t(x) + size_t(y) * m_nCols;
+				stCellPF* pCell = pGridBoard->Get(x, y);
+
+				float fCost = (pCell->stData.fWeight > 0) ? 0.f : (m_funCost ? m_funCost(*pCell) : 1.f);
+
+				m_vecMask[i] = fCost > 0.f ? 1 : 0;
+				m_vecCost[i] = fCost > 0.f ? fCost : 1.f;
+			}
+		}
+
+		size_t szSource = size_t(source.nX) + size_t(source.nY) * m_nCols;
+		if (!m_vecMask[szSource])
+			return false;
+
+		m_vecField[szSource] = 0.f;
+		m_vecMask[szSource] = 0;	// fixed
+
+		unsigned int nMaxIteration = m_nMaxIteration ? m_nMaxIteration : unsigned(m_nCols + m_nRows);
+
+		for (m_nIteration = 1; m_nIteration <= nMaxIteration; m_nIteration++)
+		{
+			float fChange = 0.f;
+			fChange = std::max(fChange, SweepRows(true));
+			fChange = std::max(fChange, SweepRows(false));
+
+			if (fChange <= m_fTolerance)
+				break;
+		}
+
+		m_stSource = source;
+		m_vecMask[szSource] = 1;
+
+		return true;
+	}
+
+public:
+	/* EIKONAL_INF_DISTANCE for obstacles and unreachable cells */
+	float Distance(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows || m_vecField.empty())
+			return EIKONAL_INF_DISTANCE;
+
+		return m_vecField[size_t(x) + size_t(y) * m_nCols];
+	}
+
+	const std::vector<float>& Field() const noexcept { return m_vecField; }
+	unsigned int Iterations() const noexcept { return m_nIteration; }
+
+	/*
+	* Descend the field from start to the source. Return false if start is
+	* not reachable
+	*/
+	bool ExtractPath(stCellIdxPF start, std::vector<stPointPF>& vecPoints, float fStep = 0.5f) const
+	{
+		vecPoints.clear();
+
+		if (Distance(start.nX, start.nY) >= EIKONAL_INF_DISTANCE)
+			return false;
+
+		stPointPF ptCur{ float(start.nX), float(start.nY) };
+		vecPoints.push_back(ptCur);
+
+		size_t szMaxStep = size_t(4.f * (m_nCols + m_nRows) / fStep) + m_vecField.size();
+
+		for (size_t nStep = 0; nStep < szMaxStep; nStep++)
+		{
+			int nX = int(std::floor(ptCur.fX + 0.5f));
+			int nY = int(std::floor(ptCur.fY + 0.5f));
+
+			if ((nX == m_stSource.nX && nY == m_stSource.nY) ||
+				(std::abs(nX - m_stSource.nX) <= 1 && std::abs(nY - m_stSource.nY) <= 1 &&
+				 CanMove(nX, nY, m_stSource.nX, m_stSource.nY)))
+				break;
+
+			float fCur = Distance(nX, nY);
+
+			// Upwind gradient
+			float fL = Distance(nX - 1, nY), fR = Distance(nX + 1, nY);
+			float fU = Distance(nX, nY - 1), fD = Distance(nX, nY + 1);
+
+			float fGx = (std::min(fL, fR) < fCur) ? ((fL < fR) ? fCur - fL : fR - fCur) : 0.f;
+			float fGy = (std::min(fU, fD) < fCur) ? ((fU < fD) ? fCur - fU : fD - fCur) : 0.f;
+			float fNorm = std::sqrt(fGx * fGx + fGy * fGy);
+
+			stPointPF ptNext = ptCur;
+			bool bMoved = false;
+
+			if (fNorm > 0.f && fNorm < EIKONAL_INF_DISTANCE)
+			{
+				ptNext.fX -= fStep * fGx / fNorm;
+				ptNext.fY -= fStep * fGy / fNorm;
+
+				int nNX = int(std::floor(ptNext.fX + 0.5f));
+				int nNY = int(std::floor(ptNext.fY + 0.5f));
+
+				bMoved = Distance(nNX, nNY) < EIKONAL_INF_DISTANCE &&
+						 ((nNX == nX && nNY == nY) || CanMove(nX, nY, nNX, nNY));
+			}
+
+			// Discrete descent when the gradient step hits an obstacle
+			if (!bMoved)
+			{
+				int nBestX = nX, nBestY = nY;
+				float fBest = fCur;
+
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						float fN = Distance(nX + dx, nY + dy);
+						if (fN < fBest && CanMove(nX, nY, nX + dx, nY + dy))
+						{
+							fBest = fN;
+							nBestX = nX + dx;
+							nBestY = nY + dy;
+						}
+					}
+				}
+
+				if (nBestX == nX && nBestY == nY)
+					return false;
+
+				ptNext = { float(nBestX), float(nBestY) };
+			}
+
+			ptCur = ptNext;
+			vecPoints.push_back(ptCur);
+		}
+
+		stPointPF ptSource{ float(m_stSource.nX), float(m_stSource.nY) };
+		if (vecPoints.back().fX != ptSource.fX || vecPoints.back().fY != ptSource.fY)
+			vecPoints.push_back(ptSource);
+
+		return true;
+	}
+
+	/*
+	* Cells crossed by the descent, 8-connected
+	*/
+	bool ExtractPath(stCellIdxPF start, std::vector<stCellPF*>& vecPath, float fStep = 0.5f) const
+	{
+		vecPath.clear();
+
+		std::vector<stPointPF> vecPoints;
+		if (!ExtractPath(start, vecPoints, fStep))
+			return false;
+
+		for (auto& pt : vecPoints)
+		{
+			stCellPF* pCell = m_pGridBoard->Get(int(std::floor(pt.fX + 0.5f)), int(std::floor(pt.fY + 0.5f)));
+
+			if (pCell && (vecPath.empty() || vecPath.back() != pCell))
+				vecPath.push_back(pCell);
+		}
+
+		return true;
+	}
+
+protected:
+	/* Diagonal moves must not squeeze between two obstacles */
+	bool CanMove(const int x0, const int y0, const int x1, const int y1) const noexcept
+	{
+		if (Distance(x1, y1) >= EIKONAL_INF_DISTANCE)
+			return false;
+
+		if (x0 == x1 || y0 == y1)
+			return true;
+
+		return Distance(x1, y0) < EIKONAL_INF_DISTANCE || Distance(x0, y1) < EIKONAL_INF_DISTANCE;
+	}
+
+	/*
+	* Godunov update of one cell from the smallest neighbor on each axis
+	*/
+	static float Update(const float fA, const float fB, const float fCost) noexcept
+	{
+		float fDel = fA - fB;
+		float fOne = std::min(fA, fB) + fCost;
+		float fDisc = std::max(2.f * fCost * fCost - fDel * fDel, 0.f);
+		float fTwo = 0.5f * (fA + fB + std::sqrt(fDisc));
+
+		return (std::abs(fDel) >= fCost) ? fOne : fTwo;
+	}
+
+	/*
+	* Sweep along y, each thread owns a range of columns. A row is first
+	* relaxed as a whole from the previous row (vectorized), then refined left
+	* to right and right to left inside the thread range. Values across a
+	* range border are read from the previous sweep.
+	*/
+	float SweepRows(const bool bDown)
+	{
+		m_vecOld = m_vecField;
+
+		std::vector<float> vecChange(util::thread_count(m_nThreads), 0.f);
+
+		util::parallel_for(0, size_t(m_nCols), [&](size_t nX0, size_t nX1, unsigned int nThread)
+		{
+			const size_t nW = size_t(m_nCols);
+			float fChange = 0.f;
+
+			for (int k = 0; k < m_nRows; k++)
+			{
+				int y = bDown ? k : m_nRows - 1 - k;
+				int yPrev = bDown ? y - 1 : y + 1;
+				int yNext = bDown ? y + 1 : y - 1;
+
+				float* pRow = &m_vecField[size_t(y) * nW];
+				const float* pOld = &m_vecOld[size_t(y) * nW];
+				const float* pPrev = (yPrev >= 0 && yPrev < m_nRows) ? &m_vecField[size_t(yPrev) * nW] : nullptr;
+				const float* pNext = (yNext >= 0 && yNext < m_nRows) ? &m_vecOld[size_t(yNext) * nW] : nullptr;
+				const float* pCost = &m_vecCost[size_t(y) * nW];
+				const uint8_t* pMask = &m_vecMask[size_t(y) * nW];
+
+				float* pB = m_vecAxisB.data() + nX0;
+				for (size_t x = nX0; x < nX1; x++)
+				{
+					pB[x - nX0] = std::min(pPrev ? pPrev[x] : EIKONAL_INF_DISTANCE,
+										   pNext ? pNext[x] : EIKONAL_INF_DISTANCE);
+				}
+
+				// Whole row from the y neighbors and the previous x values
+				for (size_t x = nX0; x < nX1; x++)
+				{
+					float fA = std::min(x > 0 ? pOld[x - 1] : EIKONAL_INF_DISTANCE,
+										x + 1 < nW ? pOld[x + 1] : EIKONAL_INF_DISTANCE);
+
+					float fNew = std::min(pRow[x], Update(fA, pB[x - nX0], pCost[x]));
+					pRow[x] = pMask[x] ? fNew : pRow[x];
+				}
+
+				// Propagate along the row inside the range
+				for (size_t x = nX0; x < nX1; x++)
+				{
+					float fL = (x > nX0) ? pRow[x - 1] : (x > 0 ? pOld[x - 1] : EIKONAL_INF_DISTANCE);
+					float fNew = std::min(pRow[x], Update(std::min(fL, pRow[x]), pB[x - nX0], pCost[x]));
+					pRow[x] = pMask[x] ? fNew : pRow[x];
+				}
+
+				for (size_t x = nX1; x-- > nX0;)
+				{
+					float fR = (x + 1 < nX1) ? pRow[x + 1] : (x + 1 < nW ? pOld[x + 1] : EIKONAL_INF_DISTANCE);
+					float fNew = std::min(pRow[x], Update(std::min(fR, pRow[x]), pB[x - nX0], pCost[x]));
+					pRow[x] = pMask[x] ? fNew : pRow[x];
+
+					fChange = std::max(fChange, pOld[x] - pRow[x]);
+				}
+			}
+
+			vecChange[nThread] = fChange;
+		}, m_nThreads);
+
+		return *std::max_element(vecChange.begin(), vecChange.end());
+	}
+
+protected:
+	GridPF*					m_pGridBoard{ nullptr };
+	int						m_nCols{ 0 };
+	int						m_nRows{ 0 };
+	stCellIdxPF				m_stSource;
+
+	FunCellCost				m_funCost;
+	unsigned int			m_nCostGeneration{ 0 };
+	unsigned int			m_nThreads{ 0 };
+	float					m_fTolerance{ 1e-4f };
+	unsigned int			m_nMaxIteration{ 0 };
+	unsigned int			m_nIteration{ 0 };
+
+	std::vector<float>		m_vecField;
+	std::vector<float>		m_vecOld;
+	std::vector<float>		m_vecCost;
+	std::vector<uint8_t>	m_vecMask;	// 1 : cell updated by the sweeps
+	std::vector<float>		m_vecAxisB;	// min of the y neighbors for one row
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// FastSweeping class
+
+/*
+* PathFinding strategy : distance field from the target then gradient descent
+* from the start. Paths follow the continuous metric instead of the 8 moves,
+* so the move options (no cross, dont cross corners) and the agent radius
+* have no meaning here : a search with one of them set finds no path.
+*/
+class FastSweeping : public PathFinding
+{
+public:
+	EikonalSolver& Solver() noexcept { return m_Solver; }
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		if (pRefOption && (!pRefOption->m_bAllowCross || pRefOption->m_bDontCrossCorners ||
+						   pRefOption->m_fAgentRadius > 0.f))
+			return path;
+
+		StatsBegin();
+
+		// Keep the field when the same target is asked on an unchanged board and cost
+		if (pGridBoard != m_pSolvedGrid || pGridBoard->Version() != m_nSolvedVersion ||
+			m_Solver.CostGeneration() != m_nSolvedCost ||
+			target.nX != m_stSolvedTarget.nX || target.nY != m_stSolvedTarget.nY)
+		{
+			m_pSolvedGrid = nullptr;
+
+			if (!m_Solver.Solve(pGridBoard, target))
+			{
+				StatsEnd();
+				return path;
+			}
+
+			m_pSolvedGrid = pGridBoard;
+			m_nSolvedVersion = pGridBoard->Version();
+			m_nSolvedCost = m_Solver.CostGeneration();
+			m_stSolvedTarget = target;
+		}
+
+		m_Solver.ExtractPath(start, path);
+
+		if (!path.empty() && start.nX == target.nX && start.nY == target.nY)
+			path.resize(1);
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	EikonalSolver	m_Solver;
+	GridPF*			m_pSolvedGrid{ nullptr };
+	unsigned int	m_nSolvedVersion{ 0 };
+	unsigned int	m_nSolvedCost{ 0 };
+	stCellIdxPF		m_stSolvedTarget;
+};
+
+#endif // XEIKONAL_H
@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Goal bounding (per cell and move, box of the targets it leads to)
+* @file  : xgoalbounds.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGOALBOUNDS_H
+#define XGOALBOUNDS_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <float.h>
+#include "xgridpf.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define GOALBOUNDS_EPSILON		1e-4f
+#define GOALBOUNDS_MAX_SIDE		65535	// box bounds are stored on 16 bits
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+/* Empty when nMinX > nMaxX */
+typedef struct _stGoalBox
+{
+	uint16_t	nMinX{ GOALBOUNDS_MAX_SIDE };
+	uint16_t	nMinY{ GOALBOUNDS_MAX_SIDE };
+	uint16_t	nMaxX{ 0 };
+	uint16_t	nMaxY{ 0 };
+} stGoalBoxPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GoalBounds class
+
+/*
+* For every cell and each of its 8 moves (AStar::WayDirection order), the
+* bounding box of the cells whose shortest path from the cell can start
+* with that move (all of them on ties). A search may skip a move whose box
+* does not hold the target, one shortest path always remains.
+* Build : one Dijkstra per cell over the whole board (a-star moves and
+* costs, for one cross / dont cross corners option) keeping the set of
+* first moves, cells split over threads, O(cells^2 log cells) : meant for
+* static maps, built offline or at load time.
+* Memory : 64 bytes per cell (8 boxes of 4 x 16 bits). The build also holds
+* 2 bytes per cell + 5 per cell and thread (Dijkstra scratch), released after.
+* Boards up to 65535 cells wide / high.
+*/
+class GoalBounds
+{
+	typedef struct _stGoalOpen
+	{
+		float		fCost{ 0.f };
+		uint32_t	nIdx{ 0 };
+
+		bool operator<(const _stGoalOpen& other) const noexcept
+		{
+			return fCost > other.fCost;
+		}
+	} stGoalOpenPF;
+
+	typedef struct _stGoalScratch
+	{
+		std::vector<float>			vecCost;
+		std::vector<uint8_t>		vecFirst;		// first moves reaching the cell optimally
+		SearchOpenList<stGoalOpenPF> Open;
+	} stGoalScratchPF;
+
+public:
+	/*******************************************************************************
+	*! @brief  : Boxes of every cell for the moves allowed (PathFinderOption flags)
+	*! @param  : [in] nThreads : 0 = all hardware threads
+	*******************************************************************************/
+	bool Build(GridPF* pGridBoard, const bool bAllowCross, const bool bDontCrossCorners,
+			   const unsigned int nThreads = 0)
+	{
+		Clear();
+
+		if (!pGridBoard || pGridBoard->Length() == 0 ||
+			pGridBoard->Cols() > GOALBOUNDS_MAX_SIDE || pGridBoard->Rows() > GOALBOUNDS_MAX_SIDE)
+			return false;
+
+		m_nCols = pGridBoard->Cols();
+		m_nRows = pGridBoard->Rows();
+		m_bAllowCross = bAllowCross;
+		m_bDontCrossCorners = bDontCrossCorners;
+
+		size_t szCells = size_t(m_nCols) * m_nRows;
+
+		m_vecBlocked.resize(szCells);
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = pGridBoard->Get(x, y);
+				m_vecBlocked[x + size_t(y) * m_nCols] = (!pCell || pCell->stData.fWeight > 0) ? 1 : 0;
+			}
+		}
+
+		// legal moves of each cell, read by every Dijkstra
+		m_vecMoves.resize(szCells);
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				uint8_t nMoves = 0;
+				for (int d = 0; d < 8; d++)
+				{
+					if (CanMove(x, y, m_arMove[d][0], m_arMove[d][1]))
+						nMoves |= uint8_t(1u << d);
+				}
+
+				m_vecMoves[x + size_t(y) * m_nCols] = nMoves;
+			}
+		}
+
+		m_vecBoxes.assign(szCells * 8, stGoalBoxPF());
+
+		unsigned int nWorkers = util::thread_count(nThreads);
+		std::vector<stGoalScratchPF> vecScratch(nWorkers);
+
+		util::parallel_for(0, szCells, [&](size_t nBegin, size_t nEnd, unsigned int t)
+		{
+			stGoalScratchPF& scratch = vecScratch[t];
+			scratch.vecCost.resize(szCells);
+			scratch.vecFirst.resize(szCells);
+
+			for (size_t i = nBegin; i < nEnd; i++)
+				BuildCell(uint32_t(i), scratch);
+		}, nWorkers);
+
+		std::vector<uint8_t>().swap(m_vecBlocked);
+		std::vector<uint8_t>().swap(m_vecMoves);
+
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = 0;
+		m_vecBoxes.clear();
+		m_vecBlocked.clear();
+		m_vecMoves.clear();
+	}
+
+public:
+	/* Built on this board, not modified since */
+	bool IsValid(GridPF* pGridBoard) const noexcept
+	{
+		return pGridBoard && m_pGridBoard == pGridBoard && m_nGridVersion == pGridBoard->Version();
+	}
+
+	/* Built for these moves (PathFinderOption flags) */
+	bool IsFor(const bool bAllowCross, const bool bDontCrossCorners) const noexcept
+	{
+		return m_bAllowCross == bAllowCross && m_bDontCrossCorners == bDontCrossCorners;
+	}
+
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+
+	/* Direction index of the move (dx, dy), AStar::WayDirection order */
+	static int Direction(const int dx, const int dy) noexcept
+	{
+		int nDir = (dy + 1) * 3 + (dx + 1);
+		return nDir > 4 ? nDir - 1 : nDir;
+	}
+
+	const stGoalBoxPF& Box(const int x, const int y, const int nDir) const noexcept
+	{
+		return m_vecBoxes[(x + size_t(y) * m_nCols) * 8 + nDir];
+	}
+
+	/*******************************************************************************
+	*! @brief  : Moves of (x, y) that may start a shortest path to the target
+	*! @return : bit Direction(dx, dy) set for each, 0 outside the board
+	*******************************************************************************/
+	uint8_t Moves(const int x, const int y, const int nTargetX, const int nTargetY) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return 0;
+
+		const stGoalBoxPF* pBox = &m_vecBoxes[(x + size_t(y) * m_nCols) * 8];
+		uint8_t nMoves = 0;
+
+		for (int d = 0; d < 8; d++)
+		{
+			if (nTargetX >= pBox[d].nMinX && nTargetX <= pBox[d].nMaxX &&
+				nTargetY >= pBox[d].nMinY && nTargetY <= pBox[d].nMaxY)
+				nMoves |= uint8_t(1u << d);
+		}
+
+		return nMoves;
+	}
+
+	size_t MemorySize() const noexcept
+	{
+		return m_vecBoxes.size() * sizeof(stGoalBoxPF);
+	}
+
+protected:
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		return x >= 0 && y >= 0 && x < m_nCols && y < m_nRows && !m_vecBlocked[x + size_t(y) * m_nCols];
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		if (!m_bAllowCross)
+			return false;
+
+		bool bSide1 = IsFree(x + dx, y);
+		bool bSide2 = IsFree(x, y + dy);
+
+		return m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+	/* Dijkstra from the cell, the first moves merged on equal costs */
+	void BuildCell(const uint32_t nSource, stGoalScratchPF& scratch)
+	{
+		std::fill(scratch.vecCost.begin(), scratch.vecCost.end(), FLT_MAX);
+		std::fill(scratch.vecFirst.begin(), scratch.vecFirst.end(), uint8_t(0));
+		scratch.Open.Clear();
+
+		stGoalBoxPF* pBoxes = &m_vecBoxes[size_t(nSource) * 8];
+
+		scratch.vecCost[nSource] = 0.f;
+		scratch.Open.Push({ 0.f, nSource });
+
+		while (!scratch.Open.Empty())
+		{
+			stGoalOpenPF stOpen = scratch.Open.Pop();
+
+			if (stOpen.fCost > scratch.vecCost[stOpen.nIdx])
+				continue;
+
+			int x = int(stOpen.nIdx % m_nCols), y = int(stOpen.nIdx / m_nCols);
+			uint8_t nCellMoves = m_vecMoves[stOpen.nIdx];
+			uint8_t nFirst = scratch.vecFirst[stOpen.nIdx];
+
+			// the first moves of the cell are final once popped
+			for (int d = 0; d < 8 && stOpen.nIdx != nSource; d++)
+			{
+				if (nFirst & (1u << d))
+				{
+					stGoalBoxPF& box = pBoxes[d];
+					box.nMinX = std::min(box.nMinX, uint16_t(x));
+					box.nMinY = std::min(box.nMinY, uint16_t(y));
+					box.nMaxX = std::max(box.nMaxX, uint16_t(x));
+					box.nMaxY = std::max(box.nMaxY, uint16_t(y));
+				}
+			}
+
+			for (int d = 0; d < 8; d++)
+			{
+				if (!(nCellMoves & (1u << d)))
+					continue;
+
+				int dx = m_arMove[d][0], dy = m_arMove[d][1];
+
+				uint32_t nNext = uint32_t((x + dx) + size_t(y + dy) * m_nCols);
+				float fCost = stOpen.fCost + ((dx != 0 && dy != 0) ? 1.412f : 1.f);
+				uint8_t nMoves = stOpen.nIdx == nSource ? uint8_t(1u << d) : nFirst;
+
+				float& fNextCost = scratch.vecCost[nNext];
+				if (fCost < fNextCost - GOALBOUNDS_EPSILON)
+				{
+					fNextCost = fCost;
+					scratch.vecFirst[nNext] = nMoves;
+					scratch.Open.Push({ fCost, nNext });
+				}
+				else if (fCost <= fNextCost + GOALBOUNDS_EPSILON)
+				{
+					scratch.vecFirst[nNext] |= nMoves;
+				}
+			}
+		}
+	}
+
+protected:
+	GridPF*						m_pGridBoard{ nullptr };
+	unsigned int				m_nGridVersion{ 0 };
+	int							m_nCols{ 0 };
+	int							m_nRows{ 0 };
+	bool						m_bAllowCross{ true };
+	bool						m_bDontCrossCorners{ false };
+
+	std::vector<stGoalBoxPF>	m_vecBoxes;		// 8 per cell
+	std::vector<uint8_t>		m_vecBlocked;	// build only
+	std::vector<uint8_t>		m_vecMoves;		// build only
+
+	// (dx, dy) of each direction
+	const int					m_arMove[8][2]{ { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 },
+												{ 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+};
+
+#endif // !XGOALBOUNDS_H
@@ -0,0 +1,591 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Bit-parallel BFS flood (reachability, unit-cost move count)
+* @file  : xgridbitflood.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDBITFLOOD_H
+#define XGRIDBITFLOOD_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xgridpf.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFBitFlood class
+
+/*
+* The walkable cells are packed in 64 bits words (one row = Words() words).
+* A BFS layer is computed for 64 cells at once with shift / and / or on the
+* frontier rows above, on and below, with the same move rules as a-star
+* (cross, dont cross corners). Only the words around the frontier are visited,
+* point to point distance searches from both ends.
+* Reachable set without depth limit : row fills swept down and up.
+* Distance is the number of moves (diagonal = 1).
+* Memory : 7 bitmaps (walkable, 2 x visited / frontier / next) + one stamp per
+* word, about cells bytes.
+* One query at a time per instance.
+*/
+class GridPFBitFlood : public GridPFListener
+{
+	typedef struct _stBitFront
+	{
+		std::vector<uint64_t>	vecVisited;
+		std::vector<uint64_t>	vecFrontier;
+		std::vector<uint64_t>	vecNext;
+		std::vector<uint32_t>	vecActive;		// words of the frontier
+		std::vector<uint32_t>	vecNextActive;
+	} stBitFrontPF;
+
+public:
+	GridPFBitFlood() = default;
+	GridPFBitFlood(const GridPFBitFlood&) = delete;
+	GridPFBitFlood& operator=(const GridPFBitFlood&) = delete;
+
+	~GridPFBitFlood()
+	{
+		Detach();
+	}
+
+public:
+	bool Attach(GridPF* pGridBoard, const bool bAllowCross = true, const bool bDontCrossCorners = false)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_bAllowCross = bAllowCross;
+		m_bDontCrossCorners = bDontCrossCorners;
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = m_nWords = 0;
+		m_vecFree.clear();
+		for (auto& front : m_Front)
+			front = stBitFrontPF();
+	}
+
+	void Build()
+	{
+		m_nCols = m_nRows = m_nWords = 0;
+		m_vecFree.clear();
+		for (auto& front : m_Front)
+			front = stBitFrontPF();
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+		m_nWords = (m_nCols + 63) / 64;
+
+		size_t szWords = size_t(m_nWords) * m_nRows;
+		m_vecFree.assign(szWords, 0);
+		for (auto& front : m_Front)
+		{
+			front.vecVisited.assign(szWords, 0);
+			front.vecFrontier.assign(szWords, 0);
+			front.vecNext.assign(szWords, 0);
+		}
+		m_vecStamp.assign(szWords, 0);
+		m_nStamp = 0;
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = m_pGridBoard->Get(x, y);
+				if (pCell && pCell->stData.fWeight <= 0)
+					m_vecFree[Word(x, y)] |= Bit(x);
+			}
+		}
+	}
+
+	void SetMove(const bool bAllowCross, const bool bDontCrossCorners) noexcept
+	{
+		m_bAllowCross = bAllowCross;
+		m_bDontCrossCorners = bDontCrossCorners;
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		if (pCell && pCell->stData.fWeight <= 0)
+			m_vecFree[Word(x, y)] |= Bit(x);
+		else
+			m_vecFree[Word(x, y)] &= ~Bit(x);
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	int Words() const noexcept { return m_nWords; }
+
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return false;
+
+		return (m_vecFree[Word(x, y)] & Bit(x)) != 0;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Cells reachable from start (within nMaxDepth moves, < 0 : no limit)
+	*! @return : number of cells reached, 0 if start is blocked
+	*! @note   : result read with IsReached / Reached
+	*******************************************************************************/
+	size_t Flood(stCellIdxPF start, const int nMaxDepth = -1)
+	{
+		if (nMaxDepth < 0)
+			Sweep(start);
+		else
+			Run(start, nMaxDepth, nullptr);
+
+		return ReachedCount();
+	}
+
+	bool CanReach(stCellIdxPF start, stCellIdxPF target, const int nMaxDepth = -1)
+	{
+		if (!IsFree(target.nX, target.nY))
+			return false;
+
+		if (nMaxDepth < 0)
+		{
+			Sweep(start);
+			return IsReached(target.nX, target.nY);
+		}
+
+		return RunBetween(start, target, nMaxDepth) >= 0;
+	}
+
+	/* Number of moves from start to target, -1 : not reachable (within nMaxDepth) */
+	int Distance(stCellIdxPF start, stCellIdxPF target, const int nMaxDepth = -1)
+	{
+		return RunBetween(start, target, nMaxDepth);
+	}
+
+	/*******************************************************************************
+	*! @brief  : Number of moves from start for every cell (x + y * cols)
+	*! @param  : [out] vecDist : -1 for the cells not reached
+	*! @return : number of layers expanded, -1 if start is blocked
+	*******************************************************************************/
+	int DistanceField(stCellIdxPF start, std::vector<int>& vecDist, const int nMaxDepth = -1)
+	{
+		vecDist.assign(size_t(m_nCols) * m_nRows, -1);
+		return Run(start, nMaxDepth, &vecDist);
+	}
+
+	/* Cells reached by the last Flood / DistanceField */
+	bool IsReached(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return false;
+
+		return (m_Front[0].vecVisited[Word(x, y)] & Bit(x)) != 0;
+	}
+
+	size_t ReachedCount() const noexcept
+	{
+		size_t szCount = 0;
+		for (uint64_t nWord : m_Front[0].vecVisited)
+			szCount += BitCount(nWord);
+
+		return szCount;
+	}
+
+	/* Bitmap of the last query, row y at [y * Words(), (y + 1) * Words()) */
+	const std::vector<uint64_t>& Reached() const noexcept { return m_Front[0].vecVisited; }
+
+protected:
+	size_t Word(const int x, const int y) const noexcept
+	{
+		return size_t(y) * m_nWords + (x >> 6);
+	}
+
+	static uint64_t Bit(const int x) noexcept
+	{
+		return uint64_t(1) << (x & 63);
+	}
+
+	static int BitCount(uint64_t nWord) noexcept
+	{
+#ifdef _MSC_VER
+		return int(__popcnt64(nWord));
+#else
+		return __builtin_popcountll(nWord);
+#endif
+	}
+
+	static int LowBit(uint64_t nWord) noexcept
+	{
+#ifdef _MSC_VER
+		unsigned long nIdx = 0;
+		_BitScanForward64(&nIdx, nWord);
+		return int(nIdx);
+#else
+		return __builtin_ctzll(nWord);
+#endif
+	}
+
+	/* Row cells moved one column right (x -> x + 1) / left (x -> x - 1), word i */
+	uint64_t ShiftRight(const uint64_t* pRow, const int i) const noexcept
+	{
+		return (pRow[i] << 1) | (i > 0 ? pRow[i - 1] >> 63 : 0);
+	}
+
+	uint64_t ShiftLeft(const uint64_t* pRow, const int i) const noexcept
+	{
+		return (pRow[i] >> 1) | (i + 1 < m_nWords ? pRow[i + 1] << 63 : 0);
+	}
+
+	/*
+	* Cells of row y (word i) reached in one diagonal move from the frontier pSrc
+	* of row ys = y -/+ 1. Side cells : (x +/- 1, ys) and (x, y).
+	*/
+	uint64_t Diagonal(const uint64_t* pSrc, const uint64_t* pSrcFree, const uint64_t* pFree, const int i) const noexcept
+	{
+		uint64_t nSideR = ShiftRight(pSrc, i) & pSrcFree[i];
+		uint64_t nSideL = ShiftLeft(pSrc, i) & pSrcFree[i];
+
+		// frontier cells whose vertical neighbor is free, then moved
+		uint64_t nVertR = ((pSrc[i] & pFree[i]) << 1) | (i > 0 ? (pSrc[i - 1] & pFree[i - 1]) >> 63 : 0);
+		uint64_t nVertL = ((pSrc[i] & pFree[i]) >> 1) | (i + 1 < m_nWords ? (pSrc[i + 1] & pFree[i + 1]) << 63 : 0);
+
+		if (m_bDontCrossCorners)
+			return (nSideR & nVertR) | (nSideL & nVertL);
+
+		return nSideR | nVertR | nSideL | nVertL;
+	}
+
+	/* Free cells of the row runs holding a seed (in place, across the words) */
+	void FillRow(uint64_t* pRow, const uint64_t* pFree) const noexcept
+	{
+		uint64_t nCarry = 0;
+		for (int i = 0; i < m_nWords; i++)
+		{
+			uint64_t g = (pRow[i] | (nCarry & pFree[i])) & pFree[i];
+			uint64_t p = pFree[i];
+
+			// Occluded fill toward the high bits
+			g |= p & (g << 1);  p &= p << 1;
+			g |= p & (g << 2);  p &= p << 2;
+			g |= p & (g << 4);  p &= p << 4;
+			g |= p & (g << 8);  p &= p << 8;
+			g |= p & (g << 16); p &= p << 16;
+			g |= p & (g << 32);
+
+			pRow[i] = g;
+			nCarry = g >> 63;
+		}
+
+		nCarry = 0;
+		for (int i = m_nWords - 1; i >= 0; i--)
+		{
+			uint64_t g = pRow[i] | (nCarry & pFree[i]);
+			uint64_t p = pFree[i];
+
+			// Toward the low bits
+			g |= p & (g >> 1);  p &= p >> 1;
+			g |= p & (g >> 2);  p &= p >> 2;
+			g |= p & (g >> 4);  p &= p >> 4;
+			g |= p & (g >> 8);  p &= p >> 8;
+			g |= p & (g >> 16); p &= p >> 16;
+			g |= p & (g >> 32);
+
+			pRow[i] = g;
+			nCarry = (g & 1) << 63;
+		}
+	}
+
+	/*
+	* Row fill sweeps down then up until nothing changes. The a-star diagonal
+	* always needs a free side cell, so the reachable set is the 4-connected one.
+	*/
+	void Sweep(stCellIdxPF start)
+	{
+		std::fill(m_Front[0].vecVisited.begin(), m_Front[0].vecVisited.end(), 0);
+
+		if (!IsFree(start.nX, start.nY))
+			return;
+
+		const int nW = m_nWords;
+		m_Front[0].vecVisited[Word(start.nX, start.nY)] = Bit(start.nX);
+		FillRow(&m_Front[0].vecVisited[size_t(start.nY) * nW], &m_vecFree[size_t(start.nY) * nW]);
+
+		// Rows holding reached cells [nBegin, nEnd]
+		int nBegin = start.nY, nEnd = start.nY;
+		bool bChanged = true;
+
+		while (bChanged)
+		{
+			bChanged = false;
+
+			// Down then up : seeds are the reached cells of the previous row
+			for (int y = std::max(nBegin, 1); y < m_nRows && y - 1 <= nEnd; y++)
+			{
+				if (SeedRow(y, y - 1))
+				{
+					bChanged = true;
+					nEnd = std::max(nEnd, y);
+				}
+			}
+
+			for (int y = std::min(nEnd, m_nRows - 2); y >= 0 && y + 1 >= nBegin; y--)
+			{
+				if (SeedRow(y, y + 1))
+				{
+					bChanged = true;
+					nBegin = std::min(nBegin, y);
+				}
+			}
+		}
+	}
+
+	/* Row y gets the free cells below / above the reached cells of row ys, then filled */
+	bool SeedRow(const int y, const int ys) noexcept
+	{
+		const int nW = m_nWords;
+		uint64_t* pRow = &m_Front[0].vecVisited[size_t(y) * nW];
+		const uint64_t* pSrc = &m_Front[0].vecVisited[size_t(ys) * nW];
+		const uint64_t* pFree = &m_vecFree[size_t(y) * nW];
+
+		bool bSeed = false;
+		for (int i = 0; i < nW; i++)
+		{
+			uint64_t nNew = pSrc[i] & pFree[i] & ~pRow[i];
+			if (nNew)
+			{
+				pRow[i] |= nNew;
+				bSeed = true;
+			}
+		}
+
+		if (bSeed)
+			FillRow(pRow, pFree);
+
+		return bSeed;
+	}
+
+	/* Frontier = start only */
+	bool Begin(stBitFrontPF& front, stCellIdxPF start)
+	{
+		std::fill(front.vecVisited.begin(), front.vecVisited.end(), 0);
+		front.vecActive.clear();
+
+		if (!IsFree(start.nX, start.nY))
+			return false;
+
+		uint32_t n = uint32_t(Word(start.nX, start.nY));
+		front.vecFrontier[n] = Bit(start.nX);
+		front.vecVisited[n] = Bit(start.nX);
+		front.vecActive.push_back(n);
+
+		return true;
+	}
+
+	void End(stBitFrontPF& front)
+	{
+		for (uint32_t n : front.vecActive)
+			front.vecFrontier[n] = 0;
+
+		front.vecActive.clear();
+	}
+
+	/*
+	* One BFS layer on the words of the frontier. Candidates are the words above /
+	* on / below an active word, and its left / right words when the border bit
+	* is set. False when nothing new is reached.
+	*/
+	bool Expand(stBitFrontPF& front, const int nLayer, std::vector<int>* pDist)
+	{
+		const int nW = m_nWords;
+
+		if (++m_nStamp == 0)
+		{
+			std::fill(m_vecStamp.begin(), m_vecStamp.end(), 0);
+			m_nStamp = 1;
+		}
+
+		m_vecCandidate.clear();
+		for (uint32_t n : front.vecActive)
+		{
+			int y = int(n / nW), i = int(n) - y * nW;
+			int i0 = (front.vecFrontier[n] & 1) && i > 0 ? i - 1 : i;
+			int i1 = (front.vecFrontier[n] >> 63) && i + 1 < nW ? i + 1 : i;
+
+			for (int yy = std::max(y - 1, 0); yy <= std::min(y + 1, m_nRows - 1); yy++)
+			{
+				for (int ii = i0; ii <= i1; ii++)
+				{
+					uint32_t c = uint32_t(size_t(yy) * nW + ii);
+					if (m_vecStamp[c] != m_nStamp)
+					{
+						m_vecStamp[c] = m_nStamp;
+						m_vecCandidate.push_back(c);
+					}
+				}
+			}
+		}
+
+		front.vecNextActive.clear();
+		for (uint32_t c : m_vecCandidate)
+		{
+			int y = int(c / nW), i = int(c) - y * nW;
+
+			const uint64_t* pFree = &m_vecFree[size_t(y) * nW];
+			const uint64_t* pCur = &front.vecFrontier[size_t(y) * nW];
+			const uint64_t* pUp = y > 0 ? pCur - nW : nullptr;
+			const uint64_t* pDown = y + 1 < m_nRows ? pCur + nW : nullptr;
+
+			uint64_t nReach = ShiftRight(pCur, i) | ShiftLeft(pCur, i);
+			if (pUp)
+				nReach |= pUp[i];
+			if (pDown)
+				nReach |= pDown[i];
+
+			if (m_bAllowCross)
+			{
+				if (pUp)
+					nReach |= Diagonal(pUp, pFree - nW, pFree, i);
+				if (pDown)
+					nReach |= Diagonal(pDown, pFree + nW, pFree, i);
+			}
+
+			nReach &= pFree[i] & ~front.vecVisited[c];
+			if (nReach == 0)
+				continue;
+
+			front.vecNext[c] = nReach;
+			front.vecVisited[c] |= nReach;
+			front.vecNextActive.push_back(c);
+
+			if (pDist)
+			{
+				int* pRowDist = pDist->data() + size_t(y) * m_nCols + size_t(i) * 64;
+				for (uint64_t nBits = nReach; nBits; nBits &= nBits - 1)
+					pRowDist[LowBit(nBits)] = nLayer;
+			}
+		}
+
+		// The new frontier becomes current, the old one is cleared
+		for (uint32_t n : front.vecActive)
+			front.vecFrontier[n] = 0;
+
+		front.vecFrontier.swap(front.vecNext);
+		front.vecActive.swap(front.vecNextActive);
+
+		return !front.vecActive.empty();
+	}
+
+	/* Layers from start, -1 if start is blocked */
+	int Run(stCellIdxPF start, const int nMaxDepth, std::vector<int>* pDist)
+	{
+		stBitFrontPF& front = m_Front[0];
+		if (!Begin(front, start))
+			return -1;
+
+		if (pDist)
+			(*pDist)[start.nX + size_t(start.nY) * m_nCols] = 0;
+
+		int nLayer = 0;
+		while ((nMaxDepth < 0 || nLayer < nMaxDepth) && Expand(front, nLayer + 1, pDist))
+			nLayer++;
+
+		End(front);
+
+		return nLayer;
+	}
+
+	/*
+	* Bidirectional : the side with the smaller frontier is expanded. The first
+	* new cells seen by the other side are at its last layer, the distance is
+	* the sum of both layers.
+	*/
+	int RunBetween(stCellIdxPF start, stCellIdxPF target, const int nMaxDepth)
+	{
+		if (!IsFree(target.nX, target.nY) || !Begin(m_Front[0], start))
+			return -1;
+
+		if (start.nX == target.nX && start.nY == target.nY)
+		{
+			End(m_Front[0]);
+			return 0;
+		}
+
+		Begin(m_Front[1], target);
+
+		int nLayer[2] = { 0, 0 };
+		int nResult = -1;
+
+		while (nResult < 0 && (nMaxDepth < 0 || nLayer[0] + nLayer[1] < nMaxDepth))
+		{
+			int d = m_Front[0].vecActive.size() <= m_Front[1].vecActive.size() ? 0 : 1;
+			stBitFrontPF& front = m_Front[d];
+			const stBitFrontPF& other = m_Front[1 - d];
+
+			if (!Expand(front, ++nLayer[d], nullptr))
+				break;
+
+			for (uint32_t n : front.vecActive)
+			{
+				if (front.vecFrontier[n] & other.vecVisited[n])
+				{
+					nResult = nLayer[0] + nLayer[1];
+					break;
+				}
+			}
+		}
+
+		End(m_Front[0]);
+		End(m_Front[1]);
+
+		return nResult;
+	}
+
+protected:
+	GridPF*					m_pGridBoard{ nullptr };
+	bool					m_bAllowCross{ true };
+	bool					m_bDontCrossCorners{ false };
+	int						m_nCols{ 0 };
+	int						m_nRows{ 0 };
+	int						m_nWords{ 0 };
+	std::vector<uint64_t>	m_vecFree;
+
+	// query
+	stBitFrontPF			m_Front[2];		// start side, target side
+	std::vector<uint32_t>	m_vecCandidate;
+	std::vector<uint32_t>	m_vecStamp;
+	uint32_t				m_nStamp{ 0 };
+};
+
+#endif // !XGRIDBITFLOOD_H
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Clearance map (distance to the nearest obstacle)
+* @file  : xgridclearance.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDCLEARANCE_H
+#define XGRIDCLEARANCE_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include "xgridpf.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFClearance class
+
+/*
+* Euclidean distance from each cell center to the nearest obstacle center, the
+* outside of the board counts as obstacle. Values are capped to the max
+* clearance so a cell change only updates the cells closer than the cap.
+* Build : exact distance transform (Felzenszwalb & Huttenlocher), O(cells).
+*/
+class GridPFClearance : public GridPFListener
+{
+public:
+	GridPFClearance() = default;
+	GridPFClearance(const GridPFClearance&) = delete;
+	GridPFClearance& operator=(const GridPFClearance&) = delete;
+
+	~GridPFClearance()
+	{
+		Detach();
+	}
+
+public:
+	/* fMaxClearance must be larger than the biggest agent radius */
+	bool Attach(GridPF* pGridBoard, const float fMaxClearance = 16.f)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr || fMaxClearance <= 0.f)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_fMaxClearance = fMaxClearance;
+		m_nRadius = int(std::ceil(fMaxClearance));
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_vecClearance.clear();
+	}
+
+	void Build()
+	{
+		m_vecClearance.clear();
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+		m_vecClearance.resize(m_pGridBoard->Length());
+
+		Transform(0, 0, m_nCols - 1, m_nRows - 1, 0, 0, m_nCols - 1, m_nRows - 1);
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	/*
+	* Only cells closer than the cap to (x, y) may change, their nearest
+	* obstacle below the cap lies in a window of twice the cap.
+	*/
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return;
+
+		int nR = m_nRadius;
+
+		Transform(std::max(x - 2 * nR, 0), std::max(y - 2 * nR, 0),
+				  std::min(x + 2 * nR, m_nCols - 1), std::min(y + 2 * nR, m_nRows - 1),
+				  std::max(x - nR, 0), std::max(y - nR, 0),
+				  std::min(x + nR, m_nCols - 1), std::min(y + nR, m_nRows - 1));
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	float MaxClearance() const noexcept { return m_fMaxClearance; }
+
+	/* 0 on obstacles and outside the board */
+	float Get(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows || m_vecClearance.empty())
+			return 0.f;
+
+		return m_vecClearance[x + y * m_nCols];
+	}
+
+	/* Agent centered on (x, y) does not overlap any obstacle */
+	bool IsClear(const int x, const int y, const float fAgentRadius) const noexcept
+	{
+		return Get(x, y) > fAgentRadius;
+	}
+
+protected:
+	bool IsBlocked(const int x, const int y)
+	{
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		return !pCell || pCell->stData.fWeight > 0;
+	}
+
+	/*
+	* 1D squared distance transform of f[0..n) into d (lower envelope of parabolas)
+	*/
+	void Transform1D(const float* f, float* d, const int n)
+	{
+		const float fInf = std::numeric_limits<float>::infinity();
+
+		m_vecV.resize(n);
+		m_vecZ.resize(size_t(n) + 1);
+
+		int k = 0;
+		int* v = m_vecV.data();
+		float* z = m_vecZ.data();
+
+		// Skip leading empty samples, the envelope starts at the first finite one
+		int q0 = 0;
+		while (q0 < n && f[q0] == fInf) q0++;
+
+		if (q0 == n)
+		{
+			std::fill(d, d + n, fInf);
+			return;
+		}
+
+		v[0] = q0;
+		z[0] = -fInf;
+		z[1] = +fInf;
+
+		for (int q = q0 + 1; q < n; q++)
+		{
+			if (f[q] == fInf)
+				continue;
+
+			float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / float(2 * q - 2 * v[k]);
+			while (s <= z[k])
+			{
+				k--;
+				s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / float(2 * q - 2 * v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = +fInf;
+		}
+
+		k = 0;
+		for (int q = 0; q < n; q++)
+		{
+			while (z[k + 1] < q)
+				k++;
+
+			float fDel = float(q - v[k]);
+			d[q] = fDel * fDel + f[v[k]];
+		}
+	}
+
+	/*
+	* Distance transform on window [x0, x1] x [y0, y1], results written back
+	* for [wx0, wx1] x [wy0, wy1]
+	*/
+	void Transform(const int x0, const int y0, const int x1, const int y1,
+				   const int wx0, const int wy0, const int wx1, const int wy1)
+	{
+		const float fInf = std::numeric_limits<float>::infinity();
+
+		int nW = x1 - x0 + 1;
+		int nH = y1 - y0 + 1;
+
+		m_vecTemp.resize(size_t(nW) * nH);
+		m_vecF.resize(std::max(nW, nH));
+		m_vecD.resize(std::max(nW, nH));
+
+		// Columns
+		for (int x = 0; x < nW; x++)
+		{
+			for (int y = 0; y < nH; y++)
+				m_vecF[y] = IsBlocked(x0 + x, y0 + y) ? 0.f : fInf;
+
+			Transform1D(m_vecF.data(), m_vecD.data(), nH);
+
+			for (int y = 0; y < nH; y++)
+				m_vecTemp[x + y * nW] = m_vecD[y];
+		}
+
+		// Rows
+		for (int y = 0; y < nH; y++)
+		{
+			Transform1D(&m_vecTemp[size_t(y) * nW], m_vecD.data(), nW);
+
+			int gy = y0 + y;
+			if (gy < wy0 || gy > wy1)
+				continue;
+
+			for (int x = 0; x < nW; x++)
+			{
+				int gx = x0 + x;
+				if (gx < wx0 || gx > wx1)
+					continue;
+
+				// Board border counts as obstacle
+				float fBorder = float(std::min(std::min(gx + 1, m_nCols - gx), std::min(gy + 1, m_nRows - gy)));
+				float fDist = std::min(std::sqrt(m_vecD[x]), fBorder);
+
+				m_vecClearance[gx + gy * m_nCols] = std::min(fDist, m_fMaxClearance);
+			}
+		}
+	}
+
+protected:
+	GridPF*				m_pGridBoard{ nullptr };
+	int					m_nCols{ 0 };
+	int					m_nRows{ 0 };
+	int					m_nRadius{ 0 };
+	float				m_fMaxClearance{ 16.f };
+	std::vector<float>	m_vecClearance;
+
+	// scratch
+	std::vector<float>	m_vecTemp;
+	std::vector<float>	m_vecF;
+	std::vector<float>	m_vecD;
+	std::vector<int>	m_vecV;
+	std::vector<float>	m_vecZ;
+};
+
+#endif // XGRIDCLEARANCE_H
@@ -0,0 +1,421 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Dynamic connectivity of the walkable cells (union-find)
+* @file  : xgridconnectivity.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDCONNECTIVITY_H
+#define XGRIDCONNECTIVITY_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xgridpf.h"
+
+#define CONNECTIVITY_NONE		UINT32_MAX
+#define CONNECTIVITY_FRONTS		8		// free neighbors of a cell
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFConnectivity class
+
+/*
+* Each free cell holds a label, labels are the elements of a union-find
+* (path halving, union by rank) : two cells are connected when their labels
+* have the same root, with the a-star moves (cross, dont cross corners).
+* Unblocking a cell : unions of the labels of its neighbors, near O(1).
+* Blocking a cell : only its 3x3 block can lose a move, so one flood front
+* is started from each neighbor of its component and the fronts run in turn, merging
+* when they meet. A front that runs out is a piece cut from the rest and
+* gets a new label, the search stops when one front is left (it keeps the
+* old labels) : the cost follows the pieces split off, not the component.
+* Labels left without cells are compacted by a rebuild when they pass twice
+* the cell count.
+* Memory : 14 bytes per cell (label, free, stamp) + 5 per label.
+* Edits and queries on the same thread (queries compress the paths).
+*/
+class GridPFConnectivity : public GridPFListener
+{
+	typedef struct _stConnFront
+	{
+		std::vector<uint32_t>	vecCells;		// every cell reached
+		std::vector<uint32_t>	vecPending;		// reached, not expanded
+		uint32_t				nGroup{ 0 };	// front merged into
+		bool					bDone{ false };
+	} stConnFrontPF;
+
+public:
+	GridPFConnectivity() = default;
+	GridPFConnectivity(const GridPFConnectivity&) = delete;
+	GridPFConnectivity& operator=(const GridPFConnectivity&) = delete;
+
+	~GridPFConnectivity()
+	{
+		Detach();
+	}
+
+public:
+	bool Attach(GridPF* pGridBoard, const bool bAllowCross = true, const bool bDontCrossCorners = false)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_bAllowCross = bAllowCross;
+		m_bDontCrossCorners = bDontCrossCorners;
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = 0;
+		m_nComponents = 0;
+		m_vecFree.clear();
+		m_vecLabel.clear();
+		m_vecParent.clear();
+		m_vecRank.clear();
+		m_vecStamp.clear();
+	}
+
+	/* Labels from scratch : one per free cell, united along the moves */
+	void Build()
+	{
+		m_nCols = m_nRows = 0;
+		m_nComponents = 0;
+		m_vecParent.clear();
+		m_vecRank.clear();
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+
+		size_t szCells = size_t(m_nCols) * m_nRows;
+		m_vecFree.assign(szCells, 0);
+		m_vecLabel.assign(szCells, CONNECTIVITY_NONE);
+		m_vecStamp.assign(szCells, 0);
+		m_nStamp = 0;
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = m_pGridBoard->Get(x, y);
+				if (pCell && pCell->stData.fWeight <= 0)
+				{
+					m_vecFree[Index(x, y)] = 1;
+					m_vecLabel[Index(x, y)] = NewLabel();
+				}
+			}
+		}
+
+		// moves are symmetric : the forward half is enough
+		static const int arHalf[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				if (!m_vecFree[Index(x, y)])
+					continue;
+
+				for (int d = 0; d < 4; d++)
+				{
+					if (CanMove(x, y, arHalf[d][0], arHalf[d][1]))
+						Union(m_vecLabel[Index(x, y)], m_vecLabel[Index(x + arHalf[d][0], y + arHalf[d][1])]);
+				}
+			}
+		}
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		bool bFree = pCell && pCell->stData.fWeight <= 0;
+
+		if (bFree == (m_vecFree[Index(x, y)] != 0))
+			return;
+
+		m_vecFree[Index(x, y)] = bFree ? 1 : 0;
+
+		if (bFree)
+			Unblock(x, y);
+		else
+			Block(x, y);
+
+		if (m_vecParent.size() > 2 * m_vecLabel.size() + 64)
+			Build();
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+
+	/* Number of connected components of free cells */
+	size_t ComponentCount() const noexcept { return m_nComponents; }
+
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		return x >= 0 && y >= 0 && x < m_nCols && y < m_nRows && m_vecFree[Index(x, y)];
+	}
+
+	/*******************************************************************************
+	*! @brief  : Component id of the cell, valid until the next edit
+	*! @return : CONNECTIVITY_NONE if blocked or outside
+	*******************************************************************************/
+	uint32_t Component(const int x, const int y)
+	{
+		if (!IsFree(x, y))
+			return CONNECTIVITY_NONE;
+
+		return Find(m_vecLabel[Index(x, y)]);
+	}
+
+	/* Both free and a path between them exists */
+	bool IsConnected(stCellIdxPF a, stCellIdxPF b)
+	{
+		uint32_t nComponent = Component(a.nX, a.nY);
+		return nComponent != CONNECTIVITY_NONE && nComponent == Component(b.nX, b.nY);
+	}
+
+	size_t MemorySize() const noexcept
+	{
+		return m_vecFree.capacity() + (m_vecLabel.capacity() + m_vecStamp.capacity() + m_vecParent.capacity()) * sizeof(uint32_t) +
+			   m_vecRank.capacity();
+	}
+
+protected:
+	uint32_t Index(const int x, const int y) const noexcept
+	{
+		return uint32_t(x + size_t(y) * m_nCols);
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		if (!m_bAllowCross)
+			return false;
+
+		bool bSide1 = IsFree(x + dx, y);
+		bool bSide2 = IsFree(x, y + dy);
+
+		return m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+	uint32_t NewLabel()
+	{
+		m_vecParent.push_back(uint32_t(m_vecParent.size()));
+		m_vecRank.push_back(0);
+		m_nComponents++;
+
+		return m_vecParent.back();
+	}
+
+	uint32_t Find(uint32_t n) noexcept
+	{
+		while (m_vecParent[n] != n)
+		{
+			m_vecParent[n] = m_vecParent[m_vecParent[n]];
+			n = m_vecParent[n];
+		}
+
+		return n;
+	}
+
+	void Union(uint32_t a, uint32_t b) noexcept
+	{
+		a = Find(a);
+		b = Find(b);
+
+		if (a == b)
+			return;
+
+		if (m_vecRank[a] < m_vecRank[b])
+			std::swap(a, b);
+
+		m_vecParent[b] = a;
+		if (m_vecRank[a] == m_vecRank[b])
+			m_vecRank[a]++;
+
+		m_nComponents--;
+	}
+
+	/* The cell joins the labels of the neighbors it reaches */
+	void Unblock(const int x, const int y)
+	{
+		uint32_t nLabel = NewLabel();
+		m_vecLabel[Index(x, y)] = nLabel;
+
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if ((dx != 0 || dy != 0) && CanMove(x, y, dx, dy))
+					Union(nLabel, m_vecLabel[Index(x + dx, y + dy)]);
+			}
+		}
+	}
+
+	uint32_t Group(uint32_t n) noexcept
+	{
+		while (m_Front[n].nGroup != n)
+			n = m_Front[n].nGroup;
+
+		return n;
+	}
+
+	/* Fronts from the neighbors of the same component, the pieces that run out get new labels */
+	void Block(const int x, const int y)
+	{
+		uint32_t nComponent = Find(m_vecLabel[Index(x, y)]);
+		m_vecLabel[Index(x, y)] = CONNECTIVITY_NONE;
+
+		// stamps : m_nStamp + front
+		if (m_nStamp > UINT32_MAX - 2 * CONNECTIVITY_FRONTS)
+		{
+			std::fill(m_vecStamp.begin(), m_vecStamp.end(), 0);
+			m_nStamp = 0;
+		}
+
+		uint32_t nBase = m_nStamp + 1;
+		m_nStamp += CONNECTIVITY_FRONTS;
+
+		uint32_t nFronts = 0;
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if ((dx == 0 && dy == 0) || !IsFree(x + dx, y + dy) ||
+					Find(m_vecLabel[Index(x + dx, y + dy)]) != nComponent)
+					continue;
+
+				stConnFrontPF& front = m_Front[nFronts];
+				front.vecCells.assign(1, Index(x + dx, y + dy));
+				front.vecPending.assign(1, Index(x + dx, y + dy));
+				front.nGroup = nFronts;
+				front.bDone = false;
+
+				m_vecStamp[Index(x + dx, y + dy)] = nBase + nFronts;
+				nFronts++;
+			}
+		}
+
+		// the cell was a whole component
+		if (nFronts == 0)
+		{
+			m_nComponents--;
+			return;
+		}
+
+		uint32_t nActive = nFronts;
+
+		while (nActive > 1)
+		{
+			for (uint32_t f = 0; f < nFronts && nActive > 1; f++)
+			{
+				stConnFrontPF& front = m_Front[f];
+				if (front.nGroup != f || front.bDone)
+					continue;
+
+				if (front.vecPending.empty())
+				{
+					// cut from the others
+					front.bDone = true;
+					nActive--;
+
+					uint32_t nLabel = NewLabel();
+					for (uint32_t nCell : front.vecCells)
+						m_vecLabel[nCell] = nLabel;
+
+					continue;
+				}
+
+				uint32_t nCell = front.vecPending.back();
+				front.vecPending.pop_back();
+
+				int cx = int(nCell % m_nCols), cy = int(nCell / m_nCols);
+
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						if ((dx == 0 && dy == 0) || !CanMove(cx, cy, dx, dy))
+							continue;
+
+						uint32_t nNext = Index(cx + dx, cy + dy);
+						uint32_t nStamp = m_vecStamp[nNext];
+
+						if (nStamp < nBase || nStamp >= nBase + nFronts)
+						{
+							m_vecStamp[nNext] = nBase + f;
+							front.vecCells.push_back(nNext);
+							front.vecPending.push_back(nNext);
+							continue;
+						}
+
+						// met an other front : take it over
+						uint32_t nOther = Group(nStamp - nBase);
+						if (nOther == f)
+							continue;
+
+						stConnFrontPF& other = m_Front[nOther];
+						front.vecCells.insert(front.vecCells.end(), other.vecCells.begin(), other.vecCells.end());
+						front.vecPending.insert(front.vecPending.end(), other.vecPending.begin(), other.vecPending.end());
+						other.vecCells.clear();
+						other.vecPending.clear();
+						other.nGroup = f;
+						nActive--;
+					}
+				}
+			}
+		}
+	}
+
+protected:
+	GridPF*						m_pGridBoard{ nullptr };
+	bool						m_bAllowCross{ true };
+	bool						m_bDontCrossCorners{ false };
+	int							m_nCols{ 0 };
+	int							m_nRows{ 0 };
+	size_t						m_nComponents{ 0 };
+
+	std::vector<uint8_t>		m_vecFree;
+	std::vector<uint32_t>		m_vecLabel;		// per cell, CONNECTIVITY_NONE if blocked
+	std::vector<uint32_t>		m_vecParent;	// per label
+	std::vector<uint8_t>		m_vecRank;		// per label
+
+	// block scratch
+	std::vector<uint32_t>		m_vecStamp;
+	uint32_t					m_nStamp{ 0 };
+	stConnFrontPF				m_Front[CONNECTIVITY_FRONTS];
+};
+
+#endif // !XGRIDCONNECTIVITY_H
@@ -0,0 +1,343 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Streaming PGM/PBM map import into GridPF
+* @file  : xgridimage.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDIMAGE_H
+#define XGRIDIMAGE_H
+
+#include <stdio.h>
+#include <share.h>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include "xgridpf.h"
+
+#define GRIDIMAGE_BUFFER_SIZE	(1 << 20)
+#define GRIDIMAGE_MAX_CELLS		(1 << 28)	// larger images are rejected (board memory)
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stImageThreshold
+{
+	float fBelow{ 0.f };	// normalized intensity [0, 1], black = 0
+	float fWeight{ 0.f };
+} stImageThresholdPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFImageLoader class
+
+/*
+* Read P1/P2/P4/P5 images (8 or 16 bits) directly into the board rows.
+* Pixel -> weight goes through a lookup table built from the thresholds :
+* the first threshold (ascending) whose level is above the normalized
+* intensity gives the weight, otherwise the default weight.
+* Default : black (< 0.5) obstacle, white walkable.
+* Memory : the board + one image row + one read buffer. Images of more than
+* GRIDIMAGE_MAX_CELLS pixels are rejected.
+*/
+class GridPFImageLoader
+{
+public:
+	GridPFImageLoader()
+	{
+		AddThreshold(0.5f, 1.f);
+	}
+
+public:
+	void SetDefaultWeight(const float fWeight) noexcept { m_fDefaultWeight = fWeight; }
+	void ClearThreshold() noexcept { m_vecThreshold.clear(); }
+
+	void AddThreshold(const float fBelow, const float fWeight)
+	{
+		stImageThresholdPF stThreshold;
+		stThreshold.fBelow = fBelow;
+		stThreshold.fWeight = fWeight;
+
+		auto it = std::upper_bound(m_vecThreshold.begin(), m_vecThreshold.end(), stThreshold,
+			[](const stImageThresholdPF& a, const stImageThresholdPF& b) { return a.fBelow < b.fBelow; });
+
+		m_vecThreshold.insert(it, stThreshold);
+	}
+
+public:
+	bool Load(GridPF* pGridBoard, const wchar_t* path)
+	{
+		FILE* file = _wfsopen(path, L"rb", _SH_DENYWR);
+		if (!file) return false;
+
+		bool bRet = Load(pGridBoard, file);
+		fclose(file);
+
+		return bRet;
+	}
+
+	/* File must be opened in binary mode */
+	bool Load(GridPF* pGridBoard, FILE* file)
+	{
+		if (!pGridBoard || !file)
+			return false;
+
+		m_pFile = file;
+		m_vecBuffer.resize(GRIDIMAGE_BUFFER_SIZE);
+		m_szBufferPos = m_szBufferLen = 0;
+
+		bool bRet = ReadHeader() && BuildTable();
+
+		if (bRet)
+		{
+			bRet = pGridBoard->BuildByRow(m_nHeight, m_nWidth,
+			[this](int /*y*/, stCellPF* pRow)
+			{
+				return ReadRow(pRow);
+			});
+		}
+
+		m_pFile = nullptr;
+		std::vector<unsigned char>().swap(m_vecBuffer);
+		std::vector<unsigned char>().swap(m_vecRow);
+
+		return bRet;
+	}
+
+	unsigned int Width() const noexcept { return m_nWidth; }
+	unsigned int Height() const noexcept { return m_nHeight; }
+
+protected:
+	/* Refill the read buffer, false at end of file */
+	bool Fill()
+	{
+		m_szBufferPos = 0;
+		m_szBufferLen = fread(m_vecBuffer.data(), 1, m_vecBuffer.size(), m_pFile);
+
+		return m_szBufferLen > 0;
+	}
+
+	int GetChar()
+	{
+		if (m_szBufferPos >= m_szBufferLen && !Fill())
+			return EOF;
+
+		return m_vecBuffer[m_szBufferPos++];
+	}
+
+	/* Skip white spaces and comments of the text parts */
+	int SkipSpace()
+	{
+		int c = GetChar();
+		while (c != EOF)
+		{
+			if (c == '#')
+			{
+				while (c != EOF && c != '\n' && c != '\r')
+					c = GetChar();
+			}
+			else if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\v' && c != '\f')
+				break;
+
+			c = GetChar();
+		}
+
+		return c;
+	}
+
+	bool ReadUInt(unsigned int& nValue)
+	{
+		int c = SkipSpace();
+		if (c < '0' || c > '9')
+			return false;
+
+		unsigned long long nVal = 0;
+		while (c >= '0' && c <= '9')
+		{
+			nVal = nVal * 10 + (c - '0');
+			if (nVal > 0xFFFFFFFFull)
+				return false;
+
+			c = GetChar();
+		}
+
+		// One white space ends the number (must not eat the binary raster)
+		if (c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\v' && c != '\f')
+			return false;
+
+		nValue = (unsigned int)nVal;
+		return true;
+	}
+
+	/* Copy szBytes of the raster */
+	bool ReadBytes(unsigned char* pData, size_t szBytes)
+	{
+		while (szBytes > 0)
+		{
+			if (m_szBufferPos >= m_szBufferLen && !Fill())
+				return false;
+
+			size_t szCopy = std::min(szBytes, m_szBufferLen - m_szBufferPos);
+			memcpy(pData, &m_vecBuffer[m_szBufferPos], szCopy);
+
+			m_szBufferPos += szCopy;
+			pData += szCopy;
+			szBytes -= szCopy;
+		}
+
+		return true;
+	}
+
+	bool ReadHeader()
+	{
+		m_nWidth = m_nHeight = 0;
+		m_nMaxValue = 1;
+
+		if (GetChar() != 'P')
+			return false;
+
+		m_nFormat = GetChar() - '0';
+		if (m_nFormat != 1 && m_nFormat != 2 && m_nFormat != 4 && m_nFormat != 5)
+			return false;
+
+		if (!ReadUInt(m_nWidth) || !ReadUInt(m_nHeight))
+			return false;
+
+		if (m_nFormat == 2 || m_nFormat == 5)
+		{
+			if (!ReadUInt(m_nMaxValue) || m_nMaxValue == 0 || m_nMaxValue > 0xFFFF)
+				return false;
+		}
+
+		// The board indexes rows / cols with int, the cells are allocated at once
+		if (m_nWidth == 0 || m_nHeight == 0 || m_nWidth > INT_MAX || m_nHeight > INT_MAX)
+			return false;
+
+		return size_t(m_nWidth) <= GRIDIMAGE_MAX_CELLS / m_nHeight;
+	}
+
+	/* One weight per pixel value */
+	bool BuildTable()
+	{
+		m_vecTable.resize(size_t(m_nMaxValue) + 1);
+
+		for (unsigned int v = 0; v <= m_nMaxValue; v++)
+		{
+			// PBM : 1 is black
+			float fIntensity = (m_nFormat == 1 || m_nFormat == 4) ? float(1 - v) : float(v) / m_nMaxValue;
+			float fWeight = m_fDefaultWeight;
+
+			for (auto& stThreshold : m_vecThreshold)
+			{
+				if (fIntensity < stThreshold.fBelow)
+				{
+					fWeight = stThreshold.fWeight;
+					break;
+				}
+			}
+
+			m_vecTable[v] = fWeight;
+		}
+
+		return true;
+	}
+
+	bool ReadRow(stCellPF* pRow)
+	{
+		const float* pTable = m_vecTable.data();
+		unsigned int nWidth = m_nWidth;
+
+		switch (m_nFormat)
+		{
+		case 1:
+		case 2:
+		{
+			unsigned int nValue = 0;
+			for (unsigned int x = 0; x < nWidth; x++)
+			{
+				if (m_nFormat == 1)
+				{
+					// P1 samples may be written without separator
+					int c = SkipSpace();
+					if (c != '0' && c != '1')
+						return false;
+					nValue = unsigned(c - '0');
+				}
+				else if (!ReadUInt(nValue) || nValue > m_nMaxValue)
+					return false;
+
+				pRow[x].stData.fWeight = pTable[nValue];
+			}
+			break;
+		}
+		case 4:
+		{
+			m_vecRow.resize((nWidth + 7) / 8);
+			if (!ReadBytes(m_vecRow.data(), m_vecRow.size()))
+				return false;
+
+			const unsigned char* pBits = m_vecRow.data();
+			for (unsigned int x = 0; x < nWidth; x++)
+				pRow[x].stData.fWeight = pTable[(pBits[x >> 3] >> (7 - (x & 7))) & 1];
+			break;
+		}
+		case 5:
+		{
+			if (m_nMaxValue < 256)
+			{
+				m_vecRow.resize(nWidth);
+				if (!ReadBytes(m_vecRow.data(), m_vecRow.size()))
+					return false;
+
+				const unsigned char* pPixel = m_vecRow.data();
+				for (unsigned int x = 0; x < nWidth; x++)
+					pRow[x].stData.fWeight = pTable[std::min<unsigned int>(pPixel[x], m_nMaxValue)];
+			}
+			else
+			{
+				// 16 bits big endian
+				m_vecRow.resize(size_t(nWidth) * 2);
+				if (!ReadBytes(m_vecRow.data(), m_vecRow.size()))
+					return false;
+
+				const unsigned char* pPixel = m_vecRow.data();
+				for (unsigned int x = 0; x < nWidth; x++)
+				{
+					unsigned int nValue = (unsigned(pPixel[2 * x]) << 8) | pPixel[2 * x + 1];
+					pRow[x].stData.fWeight = pTable[std::min(nValue, m_nMaxValue)];
+				}
+			}
+			break;
+		}
+		default:
+			return false;
+		}
+
+		return true;
+	}
+
+protected:
+	std::vector<stImageThresholdPF>	m_vecThreshold;
+	float							m_fDefaultWeight{ 0.f };
+
+	// image
+	int								m_nFormat{ 0 };
+	unsigned int					m_nWidth{ 0 };
+	unsigned int					m_nHeight{ 0 };
+	unsigned int					m_nMaxValue{ 1 };
+	std::vector<float>				m_vecTable;
+
+	// reader
+	FILE*							m_pFile{ nullptr };
+	std::vector<unsigned char>		m_vecBuffer;
+	size_t							m_szBufferPos{ 0 };
+	size_t							m_szBufferLen{ 0 };
+	std::vector<unsigned char>		m_vecRow;
+};
+
+#endif // !XGRIDIMAGE_H
@@ -0,0 +1,477 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Stacked grid layers (floors) linked by portals, search across layers
+* @file  : xgridlayers.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDLAYERS_H
+#define XGRIDLAYERS_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <float.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+
+#define GRIDLAYERS_NONE		UINT32_MAX
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stLayerIdx
+{
+	int nLayer{ 0 };
+	int nX{ 0 };
+	int nY{ 0 };
+} stLayerIdxPF;
+
+/* One way link (stairs, elevator stop ...) between two cells of any layers */
+typedef struct _stPortal
+{
+	stLayerIdxPF	stFrom;
+	stLayerIdxPF	stTo;
+	float			fCost{ 0.f };
+} stPortalPF;
+
+typedef struct _stLayerCell
+{
+	int				nLayer{ 0 };
+	stCellPF*		pCell{ nullptr };
+} stLayerCellPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFLayers class
+
+/*
+* N boards (not owned, the caller keeps them alive) sharing the same x / y
+* frame, plus a sparse portal table. Portals are kept sorted by their source
+* cell (binary search, nothing stored per cell) and rebuilt on the first
+* lookup after a change. A portal is usable when both of its cells are free.
+*/
+class GridPFLayers
+{
+public:
+	/* Index of the new layer */
+	int AddLayer(GridPF* pGridBoard)
+	{
+		m_vecLayers.push_back(pGridBoard);
+		m_bDirty = true;
+
+		return int(m_vecLayers.size()) - 1;
+	}
+
+	void ClearLayers()
+	{
+		m_vecLayers.clear();
+		m_vecPortals.clear();
+		m_bDirty = true;
+	}
+
+	GridPF* Layer(const int nLayer) const noexcept
+	{
+		if (nLayer < 0 || nLayer >= LayerCount())
+			return nullptr;
+
+		return m_vecLayers[nLayer];
+	}
+
+	int LayerCount() const noexcept
+	{
+		return int(m_vecLayers.size());
+	}
+
+	/*******************************************************************************
+	*! @brief  : Add a portal, both ways by default
+	*! @return : false if a cell is outside its layer or the cost is negative
+	*******************************************************************************/
+	bool AddPortal(const stLayerIdxPF& stFrom, const stLayerIdxPF& stTo, const float fCost, const bool bBothWays = true)
+	{
+		if (!IsInside(stFrom) || !IsInside(stTo) || fCost < 0.f)
+			return false;
+
+		m_vecPortals.push_back({ stFrom, stTo, fCost });
+		if (bBothWays)
+			m_vecPortals.push_back({ stTo, stFrom, fCost });
+
+		m_bDirty = true;
+		return true;
+	}
+
+	void ClearPortals()
+	{
+		m_vecPortals.clear();
+		m_bDirty = true;
+	}
+
+	/* Portals leaving the cell : [pBegin, pEnd) */
+	void Portals(const int nLayer, const int x, const int y, const stPortalPF*& pBegin, const stPortalPF*& pEnd)
+	{
+		Prepare();
+
+		pBegin = pEnd = nullptr;
+		if (nLayer < 0 || nLayer >= LayerCount() || m_vecLayerPortals[nLayer] == 0)
+			return;
+
+		uint64_t nKey = Key(nLayer, x, y);
+		auto it = std::lower_bound(m_vecKeys.begin(), m_vecKeys.end(), nKey);
+		auto itEnd = std::upper_bound(it, m_vecKeys.end(), nKey);
+
+		pBegin = m_vecPortals.data() + (it - m_vecKeys.begin());
+		pEnd = m_vecPortals.data() + (itEnd - m_vecKeys.begin());
+	}
+
+	size_t PortalCount() const noexcept
+	{
+		return m_vecPortals.size();
+	}
+
+	/*
+	* Lower bound of the portal costs paid to go from layer nFrom to nTo, over
+	* the part of each cost not covered by its x / y move (see LayeredSearch)
+	*/
+	float LayerDistance(const int nFrom, const int nTo)
+	{
+		Prepare();
+
+		return m_vecLayerDistance[size_t(nFrom) * m_vecLayers.size() + nTo];
+	}
+
+	/* True when no portal costs less than its x / y move (octile) */
+	bool IsOctileAdmissible()
+	{
+		Prepare();
+
+		return m_bOctile;
+	}
+
+	bool IsInside(const stLayerIdxPF& stIdx) const noexcept
+	{
+		GridPF* pGridBoard = Layer(stIdx.nLayer);
+
+		return pGridBoard && stIdx.nX >= 0 && stIdx.nY >= 0 && stIdx.nX < pGridBoard->Cols() && stIdx.nY < pGridBoard->Rows();
+	}
+
+	static float Octile(const int dx, const int dy) noexcept
+	{
+		return 1.f * std::abs(dx - dy) + 1.412f * std::min(dx, dy);
+	}
+
+protected:
+	uint64_t Key(const int nLayer, const int x, const int y) const noexcept
+	{
+		return (uint64_t(nLayer) << 32) | uint32_t(x + size_t(y) * m_vecLayers[nLayer]->Cols());
+	}
+
+	/* Sort the portals by source, layer to layer distances (Floyd, few layers) */
+	void Prepare()
+	{
+		if (!m_bDirty)
+			return;
+
+		m_bDirty = false;
+
+		const size_t nLayers = m_vecLayers.size();
+
+		std::sort(m_vecPortals.begin(), m_vecPortals.end(), [this](const stPortalPF& a, const stPortalPF& b)
+		{
+			return Key(a.stFrom.nLayer, a.stFrom.nX, a.stFrom.nY) < Key(b.stFrom.nLayer, b.stFrom.nX, b.stFrom.nY);
+		});
+
+		m_vecKeys.resize(m_vecPortals.size());
+		m_vecLayerPortals.assign(nLayers, 0);
+		m_vecLayerDistance.assign(nLayers * nLayers, FLT_MAX);
+		m_bOctile = true;
+
+		for (size_t i = 0; i < m_vecPortals.size(); i++)
+		{
+			const stPortalPF& portal = m_vecPortals[i];
+			m_vecKeys[i] = Key(portal.stFrom.nLayer, portal.stFrom.nX, portal.stFrom.nY);
+			m_vecLayerPortals[portal.stFrom.nLayer]++;
+
+			float fMove = Octile(std::abs(portal.stTo.nX - portal.stFrom.nX), std::abs(portal.stTo.nY - portal.stFrom.nY));
+			if (portal.fCost < fMove)
+				m_bOctile = false;
+		}
+
+		for (auto& portal : m_vecPortals)
+		{
+			float fMove = Octile(std::abs(portal.stTo.nX - portal.stFrom.nX), std::abs(portal.stTo.nY - portal.stFrom.nY));
+			float fExtra = m_bOctile ? portal.fCost - fMove : portal.fCost;
+
+			float& fDistance = m_vecLayerDistance[portal.stFrom.nLayer * nLayers + portal.stTo.nLayer];
+			fDistance = std::min(fDistance, fExtra);
+		}
+
+		for (size_t i = 0; i < nLayers; i++)
+			m_vecLayerDistance[i * nLayers + i] = 0.f;
+
+		for (size_t k = 0; k < nLayers; k++)
+		{
+			for (size_t i = 0; i < nLayers; i++)
+			{
+				float fIK = m_vecLayerDistance[i * nLayers + k];
+				if (fIK == FLT_MAX)
+					continue;
+
+				for (size_t j = 0; j < nLayers; j++)
+				{
+					float fKJ = m_vecLayerDistance[k * nLayers + j];
+					if (fKJ != FLT_MAX)
+						m_vecLayerDistance[i * nLayers + j] = std::min(m_vecLayerDistance[i * nLayers + j], fIK + fKJ);
+				}
+			}
+		}
+	}
+
+protected:
+	std::vector<GridPF*>		m_vecLayers;
+	std::vector<stPortalPF>		m_vecPortals;		// sorted by source once prepared
+	std::vector<uint64_t>		m_vecKeys;			// source key of each portal
+	std::vector<uint32_t>		m_vecLayerPortals;	// portals leaving each layer
+	std::vector<float>			m_vecLayerDistance;	// layers x layers, FLT_MAX = no way
+	bool						m_bOctile{ true };
+	bool						m_bDirty{ true };
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// LayeredSearch class
+
+/*
+* A-star over all the layers at once : a node is (layer, cell), the moves
+* are the a-star moves inside a layer (cross, dont cross corners) plus the
+* portals of the cell. Heuristic : octile x / y distance + the layer
+* distance of the layers table (cheapest portal costs beyond their own
+* x / y move). Consistent, so a layer pair that cannot be linked is
+* rejected at once. Portals cheaper than their x / y move (teleports) drop
+* the octile term, the search stays exact but less guided.
+* Scratch : 12 bytes per cell of all the layers, reused between queries.
+*/
+class LayeredSearch
+{
+	typedef struct _stLayeredNode
+	{
+		float		fCost{ FLT_MAX };
+		uint32_t	nPrev{ GRIDLAYERS_NONE };
+		uint32_t	nGeneration{ 0 };
+	} stLayeredNodePF;
+
+	typedef struct _stLayeredOpen
+	{
+		float		fScore{ 0.f };
+		float		fCost{ 0.f };
+		uint32_t	nIdx{ 0 };
+
+		bool operator<(const _stLayeredOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stLayeredOpenPF;
+
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/* Cost of the last path found */
+	float Cost() const noexcept
+	{
+		return m_fCost;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Shortest path between two cells of any layers
+	*! @param  : [out] vecPath : start -> target, a layer change shows as two
+	*!           consecutive cells of different layers
+	*! @return : true if found
+	*******************************************************************************/
+	bool Search(GridPFLayers* pLayers, const stLayerIdxPF& start, const stLayerIdxPF& target, std::vector<stLayerCellPF>& vecPath)
+	{
+		vecPath.clear();
+		m_fCost = 0.f;
+
+		if (!pLayers || !IsFree(pLayers, start) || !IsFree(pLayers, target))
+			return false;
+
+		if (pLayers->LayerDistance(start.nLayer, target.nLayer) == FLT_MAX)
+			return false;
+
+		m_pLayers = pLayers;
+		m_Target = target;
+		m_bOctile = pLayers->IsOctileAdmissible();
+
+		Prepare();
+
+		const int nDirs = m_Option.m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		const uint32_t nStart = NodeIndex(start);
+		const uint32_t nTarget = NodeIndex(target);
+
+		m_Open.Clear();
+
+		m_Nodes.Get(nStart).fCost = 0.f;
+		m_Open.Push({ Heuristic(start), 0.f, nStart });
+
+		while (!m_Open.Empty())
+		{
+			stLayeredOpenPF stOpen = m_Open.Pop();
+
+			if (stOpen.fCost > m_Nodes[stOpen.nIdx].fCost)
+				continue;
+
+			if (stOpen.nIdx == nTarget)
+			{
+				MakePath(nTarget, vecPath);
+				m_fCost = stOpen.fCost;
+				return true;
+			}
+
+			stLayerIdxPF cur = NodeCell(stOpen.nIdx);
+			GridPF* pGridBoard = pLayers->Layer(cur.nLayer);
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				int dx = arDir[d][0], dy = arDir[d][1];
+				if (!CanMove(pGridBoard, cur.nX, cur.nY, dx, dy))
+					continue;
+
+				Relax(stOpen, { cur.nLayer, cur.nX + dx, cur.nY + dy }, d < 4 ? 1.f : 1.412f);
+			}
+
+			const stPortalPF *pBegin, *pEnd;
+			pLayers->Portals(cur.nLayer, cur.nX, cur.nY, pBegin, pEnd);
+
+			for (const stPortalPF* pPortal = pBegin; pPortal != pEnd; pPortal++)
+			{
+				if (IsFree(pLayers, pPortal->stTo))
+					Relax(stOpen, pPortal->stTo, pPortal->fCost);
+			}
+		}
+
+		return false;
+	}
+
+protected:
+	static bool IsFree(GridPFLayers* pLayers, const stLayerIdxPF& stIdx) noexcept
+	{
+		if (!pLayers->IsInside(stIdx))
+			return false;
+
+		stCellPF* pCell = pLayers->Layer(stIdx.nLayer)->Get(stIdx.nX, stIdx.nY);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	static bool IsFree(GridPF* pGridBoard, const int x, const int y) noexcept
+	{
+		stCellPF* pCell = pGridBoard->Get(x, y);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	bool CanMove(GridPF* pGridBoard, const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(pGridBoard, x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		bool bSide1 = IsFree(pGridBoard, x + dx, y);
+		bool bSide2 = IsFree(pGridBoard, x, y + dy);
+
+		return m_Option.m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+	float Heuristic(const stLayerIdxPF& stIdx) const
+	{
+		float fLayer = m_pLayers->LayerDistance(stIdx.nLayer, m_Target.nLayer);
+		if (!m_bOctile)
+			return fLayer;
+
+		return fLayer + GridPFLayers::Octile(std::abs(stIdx.nX - m_Target.nX), std::abs(stIdx.nY - m_Target.nY));
+	}
+
+	void Relax(const stLayeredOpenPF& stOpen, const stLayerIdxPF& next, const float fMove)
+	{
+		float fLayer = m_pLayers->LayerDistance(next.nLayer, m_Target.nLayer);
+		if (fLayer == FLT_MAX)
+			return;
+
+		uint32_t nNext = NodeIndex(next);
+		float fCost = stOpen.fCost + fMove;
+
+		stLayeredNodePF& node = m_Nodes.Get(nNext);
+		if (node.fCost <= fCost)
+			return;
+
+		node.fCost = fCost;
+		node.nPrev = stOpen.nIdx;
+
+		m_Open.Push({ fCost + Heuristic(next), fCost, nNext });
+	}
+
+	/* Layer offsets in the node array, scratch sized to all the layers */
+	void Prepare()
+	{
+		const int nLayers = m_pLayers->LayerCount();
+
+		m_vecOffsets.resize(size_t(nLayers) + 1);
+		m_vecOffsets[0] = 0;
+
+		for (int i = 0; i < nLayers; i++)
+		{
+			GridPF* pGridBoard = m_pLayers->Layer(i);
+			m_vecOffsets[i + 1] = m_vecOffsets[i] + uint32_t(size_t(pGridBoard->Cols()) * pGridBoard->Rows());
+		}
+
+		m_Nodes.Begin(m_vecOffsets[nLayers]);
+	}
+
+	uint32_t NodeIndex(const stLayerIdxPF& stIdx) const noexcept
+	{
+		return m_vecOffsets[stIdx.nLayer] + uint32_t(stIdx.nX + size_t(stIdx.nY) * m_pLayers->Layer(stIdx.nLayer)->Cols());
+	}
+
+	stLayerIdxPF NodeCell(const uint32_t nIdx) const noexcept
+	{
+		int nLayer = int(std::upper_bound(m_vecOffsets.begin(), m_vecOffsets.end(), nIdx) - m_vecOffsets.begin()) - 1;
+		uint32_t nCell = nIdx - m_vecOffsets[nLayer];
+		int nCols = m_pLayers->Layer(nLayer)->Cols();
+
+		return { nLayer, int(nCell % nCols), int(nCell / nCols) };
+	}
+
+	void MakePath(const uint32_t nTarget, std::vector<stLayerCellPF>& vecPath) const
+	{
+		for (uint32_t n = nTarget; n != GRIDLAYERS_NONE; n = m_Nodes[n].nPrev)
+		{
+			stLayerIdxPF stIdx = NodeCell(n);
+			vecPath.push_back({ stIdx.nLayer, m_pLayers->Layer(stIdx.nLayer)->Get(stIdx.nX, stIdx.nY) });
+		}
+
+		std::reverse(vecPath.begin(), vecPath.end());
+	}
+
+protected:
+	PathFinderOption				m_Option;
+	GridPFLayers*					m_pLayers{ nullptr };
+	stLayerIdxPF					m_Target;
+	bool							m_bOctile{ true };
+	float							m_fCost{ 0.f };
+
+	std::vector<uint32_t>			m_vecOffsets;		// first node of each layer
+	SearchRecords<stLayeredNodePF>	m_Nodes;
+	SearchOpenList<stLayeredOpenPF>	m_Open;
+};
+
+#endif // !XGRIDLAYERS_H
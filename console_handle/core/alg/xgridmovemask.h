@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Per cell mask of the legal moves to the 8 neighbors
+* @file  : xgridmovemask.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDMOVEMASK_H
+#define XGRIDMOVEMASK_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xgridpf.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFMoveMask class
+
+/*
+* One byte per cell, bit d set when the move to the neighbor d is legal with
+* the a-star rules : the neighbor is free and, for a diagonal, the corner
+* rule holds (both side cells free with dont cross corners, one of them
+* otherwise). Bits follow AStar::WayDirection (LeftUp = 0 .. RightDown = 7).
+* A cell change only touches the masks of its 3x3 block. The mask is for one
+* corner option : a search with the other one does not use it.
+*/
+class GridPFMoveMask : public GridPFListener
+{
+public:
+	GridPFMoveMask() = default;
+	GridPFMoveMask(const GridPFMoveMask&) = delete;
+	GridPFMoveMask& operator=(const GridPFMoveMask&) = delete;
+
+	~GridPFMoveMask()
+	{
+		Detach();
+	}
+
+public:
+	bool Attach(GridPF* pGridBoard, const bool bDontCrossCorners)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_bDontCrossCorners = bDontCrossCorners;
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_vecMask.clear();
+	}
+
+	void Build()
+	{
+		m_vecMask.clear();
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+		m_vecMask.resize(m_pGridBoard->Length());
+
+		Update(0, 0, m_nCols - 1, m_nRows - 1);
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	/* (x, y) is a neighbor or a side cell only for the moves of its 3x3 block */
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return;
+
+		Update(std::max(x - 1, 0), std::max(y - 1, 0), std::min(x + 1, m_nCols - 1), std::min(y + 1, m_nRows - 1));
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	bool DontCrossCorners() const noexcept { return m_bDontCrossCorners; }
+
+	/* Bit of the move (dx, dy), dx and dy in [-1, 1] and not both 0 */
+	static uint8_t Bit(const int dx, const int dy) noexcept
+	{
+		int nDir = (dy + 1) * 3 + (dx + 1);
+		return uint8_t(1u << (nDir > 4 ? nDir - 1 : nDir));
+	}
+
+	/* 0 outside the board */
+	uint8_t Get(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows || m_vecMask.empty())
+			return 0;
+
+		return m_vecMask[x + size_t(y) * m_nCols];
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		return (Get(x, y) & Bit(dx, dy)) != 0;
+	}
+
+protected:
+	bool IsFree(const int x, const int y)
+	{
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	void Update(const int x0, const int y0, const int x1, const int y1)
+	{
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				uint8_t nMask = 0;
+
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						if ((dx == 0 && dy == 0) || !IsFree(x + dx, y + dy))
+							continue;
+
+						if (dx != 0 && dy != 0)
+						{
+							bool bSide1 = IsFree(x + dx, y);
+							bool bSide2 = IsFree(x, y + dy);
+
+							if (m_bDontCrossCorners ? !(bSide1 && bSide2) : !(bSide1 || bSide2))
+								continue;
+						}
+
+						nMask |= Bit(dx, dy);
+					}
+				}
+
+				m_vecMask[x + size_t(y) * m_nCols] = nMask;
+			}
+		}
+	}
+
+protected:
+	GridPF*					m_pGridBoard{ nullptr };
+	bool					m_bDontCrossCorners{ false };
+	int						m_nCols{ 0 };
+	int						m_nRows{ 0 };
+	std::vector<uint8_t>	m_vecMask;
+};
+
+#endif // !XGRIDMOVEMASK_H
@@ -12,6 +12,7 @@
 #define XGIRDPF_H
 
 #include <vector>
+#include <atomic>
 #include <algorithm>
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -39,12 +40,76 @@ typedef struct _stGridInfo {
 	unsigned int nCols{ 0 };
 } stGridPFInfo;
 
+class GridPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFListener class
+
+/*
+* Receive board changes to maintain derived data incrementally
+*/
+class GridPFListener
+{
+public:
+	virtual ~GridPFListener() = default;
+
+	virtual void OnGridRebuilt(GridPF* pGridBoard) = 0;
+	virtual void OnCellChanged(GridPF* pGridBoard, const int x, const int y) = 0;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////
 /***********************************************************************************/
 // GridPF class
 
 class GridPF
 {
+public:
+	GridPF() = default;
+
+	GridPF(const GridPF& other) :
+		m_GridInfo(other.m_GridInfo),
+		m_vecCells(other.m_vecCells),
+		m_nVersion(other.m_nVersion.load())
+	{
+	}
+
+	GridPF& operator=(const GridPF& other)
+	{
+		m_GridInfo = other.m_GridInfo;
+		m_vecCells = other.m_vecCells;
+		m_nVersion = other.m_nVersion.load();
+
+		NotifyRebuilt();
+		return *this;
+	}
+
+public: // Listener (not copied with the board)
+
+	void AddListener(GridPFListener* pListener)
+	{
+		if (pListener && std::find(m_vecListeners.begin(), m_vecListeners.end(), pListener) == m_vecListeners.end())
+			m_vecListeners.push_back(pListener);
+	}
+
+	void RemoveListener(GridPFListener* pListener)
+	{
+		m_vecListeners.erase(std::remove(m_vecListeners.begin(), m_vecListeners.end(), pListener), m_vecListeners.end());
+	}
+
+protected:
+	void NotifyRebuilt()
+	{
+		for (auto pListener : m_vecListeners)
+			pListener->OnGridRebuilt(this);
+	}
+
+	void NotifyCellChanged(const int x, const int y)
+	{
+		for (auto pListener : m_vecListeners)
+			pListener->OnCellChanged(this, x, y);
+	}
+
 protected:
 	int GetIndex(const int x, const int y) const noexcept
 	{
@@ -72,6 +137,7 @@ protected:
 
 	void SetBoardSize(unsigned int rows, unsigned int cols, bool bRemake = false) noexcept
 	{
+		m_nVersion++;
 		m_vecCells.clear();
 		m_GridInfo = { rows, cols };
 		m_vecCells.resize(Size());
@@ -82,8 +148,11 @@ protected:
 
 	void Clear()
 	{
+		m_nVersion++;
 		m_vecCells.clear();
 		m_GridInfo = { 0, 0 };
+
+		NotifyRebuilt();
 	}
 
 public:
@@ -101,15 +170,17 @@ public:
 		{
 			for (auto j = 0; j < (int)m_GridInfo.nCols; j++)
 			{
-				nIdx = GetIndex(i, j);
+				nIdx = GetIndex(j, i);
 				if (nIdx < 0 || nIdx >= szLength)
 					continue;
-				m_vecCells[nIdx].stIdx = { i , j };
+				m_vecCells[nIdx].stIdx = { j , i };
 				m_vecCells[nIdx].stData.pData = nullptr;
 				m_vecCells[nIdx].stData.fWeight = vecWeights[nIdx];
 			}
 		}
 
+		NotifyRebuilt();
+
 		return true;
 	}
 
@@ -131,6 +202,8 @@ public:
 			m_vecCells[nIdx].stData = vecCells[i].stData;
 		}
 
+		NotifyRebuilt();
+
 		return true;
 	}
 
@@ -148,14 +221,47 @@ public:
 		{
 			for (int j = 0; j < (int)m_GridInfo.nCols; j++)
 			{
-				nIdx = GetIndex(i, j);
+				nIdx = GetIndex(j, i);
 				if (nIdx < 0 || nIdx >= szLength)
 					continue;
-				m_vecCells[nIdx].stIdx = { i , j };
+				m_vecCells[nIdx].stIdx = { j , i };
 				m_vecCells[nIdx].stData = vecCells[nIdx];
 			}
 		}
 
+		NotifyRebuilt();
+
+		return true;
+	}
+
+	/*
+	* Fill the board row by row without an intermediate buffer
+	* fun : bool(int y, stCellPF* pRow) - pRow holds cols cells, return false to abort
+	*/
+	template<typename _Fn>
+	bool BuildByRow(unsigned int rows, unsigned int cols, _Fn&& fun)
+	{
+		// Release the old cells first so the peak stays at one board
+		std::vector<stCellPF>().swap(m_vecCells);
+
+		SetBoardSize(rows, cols);
+
+		for (int i = 0; i < (int)m_GridInfo.nRows; i++)
+		{
+			stCellPF* pRow = &m_vecCells[size_t(i) * m_GridInfo.nCols];
+
+			for (int j = 0; j < (int)m_GridInfo.nCols; j++)
+				pRow[j].stIdx = { j , i };
+
+			if (!fun(i, pRow))
+			{
+				Clear();
+				return false;
+			}
+		}
+
+		NotifyRebuilt();
+
 		return true;
 	}
 
@@ -185,6 +291,15 @@ public:
 			return;
 
 		m_vecCells[nIdx].stData = cellData;
+		m_nVersion++;
+
+		NotifyCellChanged(x, y);
+	}
+
+	/* Cell must belong to this board */
+	size_t IndexOf(const stCellPF* pCell) const noexcept
+	{
+		return size_t(pCell - m_vecCells.data());
 	}
 
 	size_t Size() const noexcept { return (size_t)m_GridInfo.nCols * m_GridInfo.nRows; }
@@ -192,9 +307,15 @@ public:
 	int Rows() const noexcept { return m_GridInfo.nRows; }
 	int Cols() const noexcept { return m_GridInfo.nCols; }
 
+	/* Changes every time the board or a cell data is modified */
+	unsigned int Version() const noexcept { return m_nVersion.load(); }
+
 protected:
-	stGridPFInfo			m_GridInfo;
-	std::vector<stCellPF>	m_vecCells;
+	stGridPFInfo				m_GridInfo;
+	std::vector<stCellPF>		m_vecCells;
+	std::atomic<unsigned int>	m_nVersion{ 0 };
+
+	std::vector<GridPFListener*> m_vecListeners;
 };
 
 
@@ -0,0 +1,499 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Multi-resolution obstacle pyramid and coarse-to-fine a-star
+* @file  : xgridpyramid.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDPYRAMID_H
+#define XGRIDPYRAMID_H
+
+#include <vector>
+#include <stdint.h>
+#include "xgridpf.h"
+#include "xastar.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+enum PyramidBlockState
+{
+	PyramidFree,		// all cells of the block are walkable
+	PyramidBlocked,		// all cells of the block are obstacles
+	PyramidMixed,
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFPyramid class
+
+/*
+* Level 0 is the board itself, a block of level k covers 2^k x 2^k cells.
+* Each level stores the number of blocked cells per block, a cell change
+* updates one counter per level.
+* Memory : 1 byte per cell + ~4/3 * 4 bytes per 4 cells for the upper levels.
+*/
+class GridPFPyramid : public GridPFListener
+{
+public:
+	GridPFPyramid() = default;
+	GridPFPyramid(const GridPFPyramid&) = delete;
+	GridPFPyramid& operator=(const GridPFPyramid&) = delete;
+
+	~GridPFPyramid()
+	{
+		Detach();
+	}
+
+public:
+	bool Attach(GridPF* pGridBoard)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_vecCellBlocked.clear();
+		m_vecLevels.clear();
+	}
+
+	void Build()
+	{
+		m_nVersion++;
+		m_vecCellBlocked.clear();
+		m_vecLevels.clear();
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+
+		m_vecCellBlocked.resize(m_pGridBoard->Length());
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = m_pGridBoard->Get(x, y);
+				m_vecCellBlocked[x + y * m_nCols] = (pCell && pCell->stData.fWeight > 0) ? 1 : 0;
+			}
+		}
+
+		// Level 1 .. top, the top level is a single block
+		int nLevel = 0;
+		while ((LevelCols(nLevel) > 1 || LevelRows(nLevel) > 1))
+		{
+			nLevel++;
+			m_vecLevels.emplace_back(size_t(LevelCols(nLevel)) * LevelRows(nLevel), 0);
+		}
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				if (m_vecCellBlocked[x + y * m_nCols])
+					AddBlocked(x, y, 1);
+			}
+		}
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		uint8_t bBlocked = (pCell && pCell->stData.fWeight > 0) ? 1 : 0;
+		uint8_t& bOld = m_vecCellBlocked[x + y * m_nCols];
+
+		if (bOld == bBlocked)
+			return;
+
+		bOld = bBlocked;
+		AddBlocked(x, y, bBlocked ? 1 : -1);
+		m_nVersion++;
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	unsigned int Version() const noexcept { return m_nVersion; }
+
+	/* Number of levels including the board level */
+	int Levels() const noexcept { return m_vecCellBlocked.empty() ? 0 : int(m_vecLevels.size()) + 1; }
+	int LevelCols(const int nLevel) const noexcept { return (m_nCols + (1 << nLevel) - 1) >> nLevel; }
+	int LevelRows(const int nLevel) const noexcept { return (m_nRows + (1 << nLevel) - 1) >> nLevel; }
+
+	PyramidBlockState GetState(const int nLevel, const int bx, const int by) const noexcept
+	{
+		if (nLevel < 0 || nLevel >= Levels() ||
+			bx < 0 || by < 0 || bx >= LevelCols(nLevel) || by >= LevelRows(nLevel))
+			return PyramidBlocked;
+
+		if (nLevel == 0)
+			return m_vecCellBlocked[bx + by * m_nCols] ? PyramidBlocked : PyramidFree;
+
+		unsigned int nBlocked = m_vecLevels[nLevel - 1][bx + by * LevelCols(nLevel)];
+		if (nBlocked == 0)
+			return PyramidFree;
+
+		return nBlocked == BlockArea(nLevel, bx, by) ? PyramidBlocked : PyramidMixed;
+	}
+
+	bool IsCellFree(const int x, const int y) const noexcept
+	{
+		return GetState(0, x, y) == PyramidFree;
+	}
+
+	/* All cells of [x0, x1] x [y0, y1] are walkable */
+	bool IsRegionFree(int x0, int y0, int x1, int y1) const noexcept
+	{
+		if (x0 > x1) std::swap(x0, x1);
+		if (y0 > y1) std::swap(y0, y1);
+
+		if (x0 < 0 || y0 < 0 || x1 >= m_nCols || y1 >= m_nRows)
+			return false;
+
+		int nTop = Levels() - 1;
+		if (nTop < 0)
+			return false;
+
+		return IsRegionFree(nTop, 0, 0, x0, y0, x1, y1);
+	}
+
+	/* Highest level whose block containing (x, y) is free, -1 if blocked */
+	int FreeLevel(const int x, const int y) const noexcept
+	{
+		int nLevel = -1;
+		for (int l = 0; l < Levels(); l++)
+		{
+			if (GetState(l, x >> l, y >> l) != PyramidFree)
+				break;
+
+			nLevel = l;
+		}
+
+		return nLevel;
+	}
+
+protected:
+	unsigned int BlockArea(const int nLevel, const int bx, const int by) const noexcept
+	{
+		int nW = std::min((bx + 1) << nLevel, m_nCols) - (bx << nLevel);
+		int nH = std::min((by + 1) << nLevel, m_nRows) - (by << nLevel);
+		return unsigned(nW * nH);
+	}
+
+	void AddBlocked(const int x, const int y, const int nDelta)
+	{
+		for (size_t l = 0; l < m_vecLevels.size(); l++)
+		{
+			int nLevel = int(l) + 1;
+			m_vecLevels[l][(x >> nLevel) + (y >> nLevel) * LevelCols(nLevel)] += nDelta;
+		}
+	}
+
+	bool IsRegionFree(const int nLevel, const int bx, const int by,
+					  const int x0, const int y0, const int x1, const int y1) const noexcept
+	{
+		int bx0 = bx << nLevel, by0 = by << nLevel;
+		int bx1 = ((bx + 1) << nLevel) - 1, by1 = ((by + 1) << nLevel) - 1;
+
+		if (bx1 < x0 || bx0 > x1 || by1 < y0 || by0 > y1 ||
+			bx >= LevelCols(nLevel) || by >= LevelRows(nLevel))
+			return true;
+
+		PyramidBlockState eState = GetState(nLevel, bx, by);
+		if (eState != PyramidMixed)
+			return eState == PyramidFree;
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (!IsRegionFree(nLevel - 1, bx * 2 + (i & 1), by * 2 + (i >> 1), x0, y0, x1, y1))
+				return false;
+		}
+
+		return true;
+	}
+
+protected:
+	GridPF*									m_pGridBoard{ nullptr };
+	int										m_nCols{ 0 };
+	int										m_nRows{ 0 };
+	unsigned int							m_nVersion{ 0 };
+
+	std::vector<uint8_t>					m_vecCellBlocked;	// level 0
+	std::vector<std::vector<unsigned int>>	m_vecLevels;		// level 1 .. top
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// PyramidAStar class
+
+/*
+* A-star using an obstacle pyramid :
+*  - blocked start / target are rejected without search
+*  - a free bounding box between start and target gives the path directly
+*  - otherwise a coarse search over the pyramid level rejects unreachable
+*    targets and restricts the fine search to a corridor around the coarse
+*    path. The corridor path may be slightly longer than the optimal one ; the
+*    full search runs when the corridor fails or coarse-to-fine is disabled.
+*/
+class PyramidAStar : public AStar
+{
+public:
+	void SetPyramid(GridPFPyramid* pPyramid) noexcept
+	{
+		m_pPyramid = pPyramid;
+		m_nCoarseLevel = -1;
+	}
+
+	/* 0 : choose the level so that the coarse board is about 64 x 64 */
+	void SetPlanningLevel(const int nLevel) noexcept
+	{
+		m_nPlanningLevel = nLevel;
+	}
+
+	void SetCoarseToFine(const bool bEnable) noexcept
+	{
+		m_bCoarseToFine = bEnable;
+	}
+
+protected:
+	int PlanningLevel() const noexcept
+	{
+		int nLevel = m_nPlanningLevel;
+		if (nLevel <= 0)
+		{
+			int nSize = std::max(m_pPyramid->Grid()->Cols(), m_pPyramid->Grid()->Rows());
+			nLevel = 1;
+			while ((nSize >> nLevel) > 64)
+				nLevel++;
+		}
+
+		return std::min(nLevel, std::max(m_pPyramid->Levels() - 1, 0));
+	}
+
+	void UpdateCoarseGrid(const int nLevel)
+	{
+		if (m_nCoarseLevel == nLevel && m_nCoarseVersion == m_pPyramid->Version())
+			return;
+
+		m_nCoarseLevel = nLevel;
+		m_nCoarseVersion = m_pPyramid->Version();
+
+		int nCols = m_pPyramid->LevelCols(nLevel);
+		int nRows = m_pPyramid->LevelRows(nLevel);
+
+		m_vecCoarseWeights.resize(size_t(nCols) * nRows);
+
+		for (int by = 0; by < nRows; by++)
+		{
+			for (int bx = 0; bx < nCols; bx++)
+			{
+				m_vecCoarseWeights[bx + by * nCols] =
+					(m_pPyramid->GetState(nLevel, bx, by) == PyramidBlocked) ? 1.f : 0.f;
+			}
+		}
+
+		m_CoarseGrid.BuildFrom(m_vecCoarseWeights, nRows, nCols);
+	}
+
+	/*
+	* Coarse search on the planning level. Any fine path only crosses blocks
+	* that are not fully blocked, so no coarse path means no fine path.
+	*/
+	bool BuildCorridor(stCellIdxPF start, stCellIdxPF target)
+	{
+		int nLevel = PlanningLevel();
+		if (nLevel <= 0)
+			return true;
+
+		UpdateCoarseGrid(nLevel);
+
+		PathFinderOption option;
+		option.m_bAllowCross = true;
+		option.m_bDontCrossCorners = false;
+
+		m_CoarseFinder.Prepar(&m_CoarseGrid, &m_CoarseAStar);
+		m_CoarseFinder.SetOption(option);
+
+		stCellIdxPF stCoarseStart{ start.nX >> nLevel, start.nY >> nLevel };
+		stCellIdxPF stCoarseTarget{ target.nX >> nLevel, target.nY >> nLevel };
+
+		if (m_CoarseFinder.Search(stCoarseStart, stCoarseTarget, m_vecCoarsePath) == 0)
+			return false;
+
+		int nCols = m_CoarseGrid.Cols();
+		int nRows = m_CoarseGrid.Rows();
+
+		m_vecCorridor.assign(size_t(nCols) * nRows, 0);
+
+		for (auto pCell : m_vecCoarsePath)
+		{
+			for (int dy = -1; dy <= 1; dy++)
+			{
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					int bx = pCell->stIdx.nX + dx;
+					int by = pCell->stIdx.nY + dy;
+
+					if (bx >= 0 && by >= 0 && bx < nCols && by < nRows)
+						m_vecCorridor[bx + by * nCols] = 1;
+				}
+			}
+		}
+
+		m_nCorridorLevel = nLevel;
+		m_nCorridorCols = nCols;
+		m_bCorridor = true;
+
+		return true;
+	}
+
+	/*
+	* Diagonal moves first then straight moves, all inside a free box
+	*/
+	void BuildDirectPath(stCellIdxPF start, stCellIdxPF target)
+	{
+		stAStarCellPF* pPrev = GetCell(start);
+		stCellIdxPF stCur = start;
+
+		bool bCross = pRefOption->m_bAllowCross;
+
+		while (stCur.nX != target.nX || stCur.nY != target.nY)
+		{
+			int dx = (target.nX > stCur.nX) - (target.nX < stCur.nX);
+			int dy = (target.nY > stCur.nY) - (target.nY < stCur.nY);
+
+			if (!bCross && dx != 0)
+				dy = 0;
+
+			stCellIdxPF stNext{ stCur.nX + dx, stCur.nY + dy };
+			stAStarCellPF* pNext = GetCell(stNext);
+
+			pNext->fDistanceSrc = pPrev->fDistanceSrc + ((dx != 0 && dy != 0) ? 1.412f : 1.f);
+			pNext->pPrev = pPrev;
+
+			pPrev = pNext;
+			stCur = stNext;
+		}
+	}
+
+protected:
+	virtual bool IsCellMoveableTo(stAStarCellPF* _pCellCur, stAStarCellPF* _pCellNext)
+	{
+		if (m_bCorridor && _pCellNext)
+		{
+			int bx = _pCellNext->pGrid->stIdx.nX >> m_nCorridorLevel;
+			int by = _pCellNext->pGrid->stIdx.nY >> m_nCorridorLevel;
+
+			if (!m_vecCorridor[bx + by * m_nCorridorCols])
+				return false;
+		}
+
+		return AStar::IsCellMoveableTo(_pCellCur, _pCellNext);
+	}
+
+	virtual bool SearchBegin(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		m_bCorridor = false;
+
+		// The pyramid does not know the agent size
+		bool bAgentSize = pRefOption->m_fAgentRadius > 0.f && m_pClearance;
+
+		if (!m_pPyramid || m_pPyramid->Grid() != pGridBoard || m_pPyramid->Levels() == 0 || bAgentSize)
+			return AStar::SearchBegin(pGridBoard, start, target);
+
+		m_eSearchState = SearchNotFound;
+		m_nSearchExpanded = 0;
+
+		if (!m_pPyramid->IsCellFree(start.nX, start.nY) ||
+			!m_pPyramid->IsCellFree(target.nX, target.nY))
+			return false;
+
+		if (m_pPyramid->IsRegionFree(start.nX, start.nY, target.nX, target.nY))
+		{
+			if (!Prepar(pGridBoard))
+				return false;
+
+			StatsBegin();
+
+			m_stSearchStart = start;
+			m_stSearchEnd = target;
+			m_pSearchCur = m_pSearchStart = GetCell(start);
+			m_pSearchTarget = GetCell(target);
+
+			BuildDirectPath(start, target);
+
+			m_eSearchState = SearchFound;
+			StatsEnd();
+			return true;
+		}
+
+		if (m_bCoarseToFine && !BuildCorridor(start, target))
+			return false;
+
+		return AStar::SearchBegin(pGridBoard, start, target);
+	}
+
+	virtual size_t SearchStep(size_t nMaxExpansions)
+	{
+		size_t nStep = AStar::SearchStep(nMaxExpansions);
+
+		// Corridor too narrow : search the whole board
+		if (m_eSearchState == SearchNotFound && m_bCorridor)
+		{
+			m_bCorridor = false;
+
+			if (AStar::SearchBegin(m_pGridBoard, m_stSearchStart, m_stSearchEnd))
+				nStep = std::max(nStep, size_t(1));
+		}
+
+		return nStep;
+	}
+
+protected:
+	GridPFPyramid*			m_pPyramid{ nullptr };
+	int						m_nPlanningLevel{ 0 };
+	bool					m_bCoarseToFine{ true };
+
+	GridPF					m_CoarseGrid;
+	AStar					m_CoarseAStar;
+	PathFinder				m_CoarseFinder;
+	std::vector<float>		m_vecCoarseWeights;
+	std::vector<stCellPF*>	m_vecCoarsePath;
+	int						m_nCoarseLevel{ -1 };
+	unsigned int			m_nCoarseVersion{ 0 };
+
+	std::vector<uint8_t>	m_vecCorridor;
+	int						m_nCorridorLevel{ 0 };
+	int						m_nCorridorCols{ 0 };
+	bool					m_bCorridor{ false };
+};
+
+#endif // XGRIDPYRAMID_H
@@ -0,0 +1,595 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Quadtree region decomposition and region search
+* @file  : xgridquadtree.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDQUADTREE_H
+#define XGRIDQUADTREE_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xgridpf.h"
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+enum QuadNodeState : unsigned char
+{
+	QuadFree,		// all cells of the square are walkable
+	QuadBlocked,	// all cells are obstacles or outside the board
+	QuadMixed,		// inner node
+};
+
+typedef struct _stQuadNode
+{
+	int				nX{ 0 };
+	int				nY{ 0 };
+	int				nSize{ 1 };
+	int				nChild{ -1 };		// first of the 4 children (x-major), -1 for a leaf
+	QuadNodeState	eState{ QuadBlocked };
+} stQuadNodePF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFQuadTree class
+
+/*
+* Decompose the board into maximal free / blocked squares aligned on a power
+* of two root. A cell change splits the leaf holding it and merges the
+* siblings back on the way up : O(log size) nodes touched.
+*/
+class GridPFQuadTree : public GridPFListener
+{
+public:
+	GridPFQuadTree() = default;
+	GridPFQuadTree(const GridPFQuadTree&) = delete;
+	GridPFQuadTree& operator=(const GridPFQuadTree&) = delete;
+
+	~GridPFQuadTree()
+	{
+		Detach();
+	}
+
+public:
+	bool Attach(GridPF* pGridBoard)
+	{
+		Detach();
+
+		if (pGridBoard == nullptr)
+			return false;
+
+		m_pGridBoard = pGridBoard;
+		m_pGridBoard->AddListener(this);
+
+		Build();
+
+		return true;
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+		m_vecNodes.clear();
+		m_vecFreeBlocks.clear();
+		m_nLeaves = 0;
+	}
+
+	void Build()
+	{
+		m_nVersion++;
+		m_vecNodes.clear();
+		m_vecFreeBlocks.clear();
+		m_nLeaves = 0;
+
+		if (!m_pGridBoard || m_pGridBoard->Length() == 0)
+			return;
+
+		m_nCols = m_pGridBoard->Cols();
+		m_nRows = m_pGridBoard->Rows();
+
+		int nSize = 1;
+		while (nSize < m_nCols || nSize < m_nRows)
+			nSize <<= 1;
+
+		stQuadNodePF stRoot;
+		stRoot.nSize = nSize;
+		m_vecNodes.push_back(stRoot);
+		m_nLeaves = 1;
+
+		BuildNode(0);
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* /*pGridBoard*/)
+	{
+		Build();
+	}
+
+	virtual void OnCellChanged(GridPF* /*pGridBoard*/, const int x, const int y)
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows || m_vecNodes.empty())
+			return;
+
+		QuadNodeState eState = IsCellBlocked(x, y) ? QuadBlocked : QuadFree;
+
+		// Descend to the leaf, keep the ancestors for the merge
+		int nStack[32];
+		int nDepth = 0;
+		int nNode = 0;
+
+		while (m_vecNodes[nNode].nChild >= 0)
+		{
+			nStack[nDepth++] = nNode;
+			nNode = ChildOf(nNode, x, y);
+		}
+
+		if (m_vecNodes[nNode].eState == eState)
+			return;
+
+		// Split down to the cell, the siblings keep the old state
+		while (m_vecNodes[nNode].nSize > 1)
+		{
+			Split(nNode);
+			nStack[nDepth++] = nNode;
+			nNode = ChildOf(nNode, x, y);
+		}
+
+		m_vecNodes[nNode].eState = eState;
+
+		while (nDepth > 0 && Merge(nStack[nDepth - 1]))
+			nDepth--;
+
+		m_nVersion++;
+	}
+
+public:
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	unsigned int Version() const noexcept { return m_nVersion; }
+
+	size_t NodeCount() const noexcept { return m_vecNodes.size(); }
+	size_t LeafCount() const noexcept { return m_nLeaves; }
+	const stQuadNodePF& Node(const int nNode) const noexcept { return m_vecNodes[nNode]; }
+
+	/* Leaf holding the cell, -1 outside the board */
+	int FindLeaf(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows || m_vecNodes.empty())
+			return -1;
+
+		int nNode = 0;
+		while (m_vecNodes[nNode].nChild >= 0)
+			nNode = ChildOf(nNode, x, y);
+
+		return nNode;
+	}
+
+	bool IsCellFree(const int x, const int y) const noexcept
+	{
+		int nLeaf = FindLeaf(x, y);
+		return nLeaf >= 0 && m_vecNodes[nLeaf].eState == QuadFree;
+	}
+
+	/*
+	* Free leaves sharing an edge with the leaf, and the diagonal ones touching
+	* a corner when bCross (corner cutting rules of the a-star)
+	*/
+	void GetNeighbors(const int nLeaf, std::vector<int>& vecNeighbors,
+					  const bool bCross, const bool bDontCrossCorners) const
+	{
+		vecNeighbors.clear();
+
+		const stQuadNodePF& node = m_vecNodes[nLeaf];
+		int x0 = node.nX, y0 = node.nY;
+		int x1 = node.nX + node.nSize - 1, y1 = node.nY + node.nSize - 1;
+
+		// Left / right edges
+		for (int nSide = 0; nSide < 2; nSide++)
+		{
+			int x = nSide ? x1 + 1 : x0 - 1;
+			int y = y0;
+			while (y <= y1)
+			{
+				int nNext = FindLeaf(x, y);
+				if (nNext < 0)
+					break;
+
+				if (m_vecNodes[nNext].eState == QuadFree)
+					vecNeighbors.push_back(nNext);
+
+				y = m_vecNodes[nNext].nY + m_vecNodes[nNext].nSize;
+			}
+		}
+
+		// Top / bottom edges
+		for (int nSide = 0; nSide < 2; nSide++)
+		{
+			int y = nSide ? y1 + 1 : y0 - 1;
+			int x = x0;
+			while (x <= x1)
+			{
+				int nNext = FindLeaf(x, y);
+				if (nNext < 0)
+					break;
+
+				if (m_vecNodes[nNext].eState == QuadFree)
+					vecNeighbors.push_back(nNext);
+
+				x = m_vecNodes[nNext].nX + m_vecNodes[nNext].nSize;
+			}
+		}
+
+		if (!bCross)
+			return;
+
+		const int nCorner[4][4] = { { x0, y0, -1, -1 }, { x1, y0, 1, -1 },
+									{ x0, y1, -1, 1 }, { x1, y1, 1, 1 } };
+
+		for (int i = 0; i < 4; i++)
+		{
+			int cx = nCorner[i][0], cy = nCorner[i][1];
+			int dx = nCorner[i][2], dy = nCorner[i][3];
+
+			int nNext = FindLeaf(cx + dx, cy + dy);
+			if (nNext < 0 || m_vecNodes[nNext].eState != QuadFree)
+				continue;
+
+			bool bFree1 = IsCellFree(cx + dx, cy);
+			bool bFree2 = IsCellFree(cx, cy + dy);
+
+			if (bDontCrossCorners ? (bFree1 && bFree2) : (bFree1 || bFree2))
+				vecNeighbors.push_back(nNext);
+		}
+	}
+
+protected:
+	bool IsCellBlocked(const int x, const int y)
+	{
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		return !pCell || pCell->stData.fWeight > 0;
+	}
+
+	int ChildOf(const int nNode, const int x, const int y) const noexcept
+	{
+		const stQuadNodePF& node = m_vecNodes[nNode];
+		int nHalf = node.nSize >> 1;
+
+		return node.nChild + ((x >= node.nX + nHalf) ? 1 : 0) + ((y >= node.nY + nHalf) ? 2 : 0);
+	}
+
+	int AllocBlock()
+	{
+		if (!m_vecFreeBlocks.empty())
+		{
+			int nBlock = m_vecFreeBlocks.back();
+			m_vecFreeBlocks.pop_back();
+			return nBlock;
+		}
+
+		int nBlock = (int)m_vecNodes.size();
+		m_vecNodes.resize(m_vecNodes.size() + 4);
+		return nBlock;
+	}
+
+	/* Turn a leaf into 4 leaves of the same state */
+	void Split(const int nNode)
+	{
+		int nBlock = AllocBlock();
+
+		stQuadNodePF& node = m_vecNodes[nNode];
+		int nHalf = node.nSize >> 1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			stQuadNodePF& child = m_vecNodes[nBlock + i];
+			child.nX = node.nX + ((i & 1) ? nHalf : 0);
+			child.nY = node.nY + ((i & 2) ? nHalf : 0);
+			child.nSize = nHalf;
+			child.nChild = -1;
+			child.eState = node.eState;
+		}
+
+		node.nChild = nBlock;
+		node.eState = QuadMixed;
+		m_nLeaves += 3;
+	}
+
+	/* Collapse 4 leaves of the same state, false if the node stays inner */
+	bool Merge(const int nNode)
+	{
+		int nBlock = m_vecNodes[nNode].nChild;
+		QuadNodeState eState = m_vecNodes[nBlock].eState;
+
+		for (int i = 0; i < 4; i++)
+		{
+			const stQuadNodePF& child = m_vecNodes[nBlock + i];
+			if (child.nChild >= 0 || child.eState != eState)
+				return false;
+		}
+
+		m_vecNodes[nNode].nChild = -1;
+		m_vecNodes[nNode].eState = eState;
+		m_vecFreeBlocks.push_back(nBlock);
+		m_nLeaves -= 3;
+
+		return true;
+	}
+
+	/* Node must be a leaf */
+	void BuildNode(const int nNode)
+	{
+		int nX = m_vecNodes[nNode].nX;
+		int nY = m_vecNodes[nNode].nY;
+
+		if (nX >= m_nCols || nY >= m_nRows)
+		{
+			m_vecNodes[nNode].eState = QuadBlocked;
+			return;
+		}
+
+		if (m_vecNodes[nNode].nSize == 1)
+		{
+			m_vecNodes[nNode].eState = IsCellBlocked(nX, nY) ? QuadBlocked : QuadFree;
+			return;
+		}
+
+		// Children first, merged back when uniform (the block is reused at once)
+		Split(nNode);
+
+		int nBlock = m_vecNodes[nNode].nChild;
+		for (int i = 0; i < 4; i++)
+			BuildNode(nBlock + i);
+
+		Merge(nNode);
+	}
+
+protected:
+	GridPF*						m_pGridBoard{ nullptr };
+	int							m_nCols{ 0 };
+	int							m_nRows{ 0 };
+	unsigned int				m_nVersion{ 0 };
+	size_t						m_nLeaves{ 0 };
+
+	std::vector<stQuadNodePF>	m_vecNodes;			// node 0 is the root
+	std::vector<int>			m_vecFreeBlocks;	// released children blocks
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// QuadTreeSearch class
+
+/*
+* A-star over the free leaves : each leaf is entered at the cell closest to
+* the previous entry point, moves inside a free square are always straight.
+* Paths are near optimal (the entry point is chosen greedily) and the cost
+* of a search depends on the number of leaves, not the number of cells.
+*/
+class QuadTreeSearch : public PathFinding
+{
+	typedef struct _stQuadSearchNode
+	{
+		unsigned int	nGeneration{ 0 };
+		bool			bClosed{ false };
+		int				nPrev{ -1 };
+		int				nEntryX{ 0 };
+		int				nEntryY{ 0 };
+		float			fCost{ -1.f };		// < 0 : not reached
+	} stQuadSearchNodePF;
+
+	typedef struct _stQuadOpen
+	{
+		float	fScore{ 0.f };
+		int		nLeaf{ -1 };
+
+		bool operator<(const _stQuadOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stQuadOpenPF;
+
+public:
+	/* External tree (must be attached to the searched board), nullptr : internal tree */
+	void SetQuadTree(GridPFQuadTree* pQuadTree) noexcept
+	{
+		m_pQuadTree = pQuadTree;
+	}
+
+	GridPFQuadTree* GetQuadTree() noexcept
+	{
+		return m_pQuadTree ? m_pQuadTree : &m_QuadTree;
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		if (!pGridBoard)
+			return path;
+
+		GridPFQuadTree* pTree = m_pQuadTree;
+		if (!pTree || pTree->Grid() != pGridBoard)
+		{
+			pTree = &m_QuadTree;
+			if (pTree->Grid() != pGridBoard)
+				pTree->Attach(pGridBoard);
+		}
+
+		m_bCross = !pRefOption || pRefOption->m_bAllowCross;
+		m_bDontCrossCorners = pRefOption && pRefOption->m_bDontCrossCorners;
+
+		StatsBegin();
+
+		int nGoal = Search(pTree, pGridBoard, start, target);
+		if (nGoal >= 0)
+			MakePath(pTree, pGridBoard, nGoal, target, path);
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	float GetDistance(const int x0, const int y0, const int x1, const int y1) const noexcept
+	{
+		int dx = std::abs(x1 - x0);
+		int dy = std::abs(y1 - y0);
+
+		if (!m_bCross)
+			return float(dx + dy);
+
+		return 1.f * std::abs(dx - dy) + 1.412f * std::min(dx, dy);
+	}
+
+	/* Return the target leaf, -1 when not found */
+	int Search(GridPFQuadTree* pTree, GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		int nStart = pTree->FindLeaf(start.nX, start.nY);
+		int nGoal = pTree->FindLeaf(target.nX, target.nY);
+
+		if (nStart < 0 || nGoal < 0 ||
+			pTree->Node(nStart).eState != QuadFree || pTree->Node(nGoal).eState != QuadFree)
+			return -1;
+
+		m_Records.Begin(pTree->NodeCount());
+		m_Open.Clear();
+
+		stQuadSearchNodePF& recStart = m_Records.Get(nStart);
+		recStart.nEntryX = start.nX;
+		recStart.nEntryY = start.nY;
+		recStart.fCost = 0.f;
+
+		m_Open.Push({ GetDistance(start.nX, start.nY, target.nX, target.nY), nStart });
+		StatsPush(pGridBoard->Get(start), m_Open.Size());
+
+		while (!m_Open.Empty())
+		{
+			stQuadOpenPF stOpen = m_Open.Pop();
+
+			stQuadSearchNodePF& rec = m_Records.Get(stOpen.nLeaf);
+			if (rec.bClosed)
+				continue;
+
+			rec.bClosed = true;
+			StatsPop(pGridBoard->Get(rec.nEntryX, rec.nEntryY));
+
+			if (stOpen.nLeaf == nGoal)
+				return nGoal;
+
+			const stQuadNodePF& node = pTree->Node(stOpen.nLeaf);
+			pTree->GetNeighbors(stOpen.nLeaf, m_vecNeighbors, m_bCross, m_bDontCrossCorners);
+
+			for (int nNext : m_vecNeighbors)
+			{
+				stQuadSearchNodePF& recNext = m_Records.Get(nNext);
+				if (recNext.bClosed)
+					continue;
+
+				const stQuadNodePF& next = pTree->Node(nNext);
+
+				// Entry cell of the next leaf, and the exit cell of the current leaf next to it
+				int nEntryX = std::min(std::max(rec.nEntryX, next.nX), next.nX + next.nSize - 1);
+				int nEntryY = std::min(std::max(rec.nEntryY, next.nY), next.nY + next.nSize - 1);
+				int nExitX = std::min(std::max(nEntryX, node.nX), node.nX + node.nSize - 1);
+				int nExitY = std::min(std::max(nEntryY, node.nY), node.nY + node.nSize - 1);
+
+				float fCost = rec.fCost + GetDistance(rec.nEntryX, rec.nEntryY, nExitX, nExitY) +
+									  GetDistance(nExitX, nExitY, nEntryX, nEntryY);
+
+				if (recNext.fCost >= 0.f && recNext.fCost <= fCost)
+					continue;
+
+				if (recNext.fCost >= 0.f)
+					StatsDecreaseKey(pGridBoard->Get(nEntryX, nEntryY));
+
+				recNext.fCost = fCost;
+				recNext.nPrev = stOpen.nLeaf;
+				recNext.nEntryX = nEntryX;
+				recNext.nEntryY = nEntryY;
+
+				m_Open.Push({ fCost + GetDistance(nEntryX, nEntryY, target.nX, target.nY), nNext });
+				StatsPush(pGridBoard->Get(nEntryX, nEntryY), m_Open.Size());
+			}
+		}
+
+		return -1;
+	}
+
+	/* Straight moves inside a free square, the first cell is not added */
+	void AddSegment(GridPF* pGridBoard, int x, int y, const int x1, const int y1,
+					std::vector<stCellPF*>& path)
+	{
+		while (x != x1 || y != y1)
+		{
+			int dx = (x1 > x) - (x1 < x);
+			int dy = (y1 > y) - (y1 < y);
+
+			if (!m_bCross && dx != 0)
+				dy = 0;
+
+			x += dx;
+			y += dy;
+			path.push_back(pGridBoard->Get(x, y));
+		}
+	}
+
+	void MakePath(GridPFQuadTree* pTree, GridPF* pGridBoard, int nGoal, stCellIdxPF target,
+				  std::vector<stCellPF*>& path)
+	{
+		m_vecChain.clear();
+		for (int nLeaf = nGoal; nLeaf >= 0; nLeaf = m_Records[nLeaf].nPrev)
+			m_vecChain.push_back(nLeaf);
+
+		std::reverse(m_vecChain.begin(), m_vecChain.end());
+
+		const stQuadSearchNodePF& recStart = m_Records[m_vecChain[0]];
+		int x = recStart.nEntryX, y = recStart.nEntryY;
+		path.push_back(pGridBoard->Get(x, y));
+
+		for (size_t i = 0; i + 1 < m_vecChain.size(); i++)
+		{
+			const stQuadNodePF& node = pTree->Node(m_vecChain[i]);
+			const stQuadSearchNodePF& recNext = m_Records[m_vecChain[i + 1]];
+
+			int nExitX = std::min(std::max(recNext.nEntryX, node.nX), node.nX + node.nSize - 1);
+			int nExitY = std::min(std::max(recNext.nEntryY, node.nY), node.nY + node.nSize - 1);
+
+			AddSegment(pGridBoard, x, y, nExitX, nExitY, path);
+			AddSegment(pGridBoard, nExitX, nExitY, recNext.nEntryX, recNext.nEntryY, path);
+
+			x = recNext.nEntryX;
+			y = recNext.nEntryY;
+		}
+
+		AddSegment(pGridBoard, x, y, target.nX, target.nY, path);
+	}
+
+protected:
+	GridPFQuadTree*						m_pQuadTree{ nullptr };
+	GridPFQuadTree						m_QuadTree;
+	bool								m_bCross{ true };
+	bool								m_bDontCrossCorners{ false };
+
+	// search
+	SearchRecords<stQuadSearchNodePF>	m_Records;
+	SearchOpenList<stQuadOpenPF>		m_Open;
+	std::vector<int>					m_vecNeighbors;
+	std::vector<int>					m_vecChain;
+};
+
+#endif // !XGRIDQUADTREE_H
@@ -0,0 +1,325 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Copy-on-write tiled snapshots of a grid (edit while searching)
+* @file  : xgridsnapshot.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XGRIDSNAPSHOT_H
+#define XGRIDSNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <stdint.h>
+#include "xgridpf.h"
+
+#define GRIDSNAPSHOT_TILE		32		// tile side in cells
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stGridTile
+{
+	stCellDataPF arData[GRIDSNAPSHOT_TILE * GRIDSNAPSHOT_TILE];
+} stGridTilePF;
+
+typedef std::shared_ptr<const stGridTilePF> GridTilePtr;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFSnapshot class
+
+/*
+* Immutable cell data of a grid at one version. Tiles are shared with the
+* other snapshots as long as none of their cells changed.
+*/
+class GridPFSnapshot
+{
+	friend class GridPFSnapshots;
+
+public:
+	const stCellDataPF* Get(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return nullptr;
+
+		const GridTilePtr& pTile = m_vecTiles[size_t(x / GRIDSNAPSHOT_TILE) + size_t(y / GRIDSNAPSHOT_TILE) * m_nTileCols];
+		return &pTile->arData[(x % GRIDSNAPSHOT_TILE) + (y % GRIDSNAPSHOT_TILE) * GRIDSNAPSHOT_TILE];
+	}
+
+	const GridTilePtr& Tile(const size_t nTile) const noexcept
+	{
+		return m_vecTiles[nTile];
+	}
+
+	size_t TileCount() const noexcept { return m_vecTiles.size(); }
+	int TileCols() const noexcept { return m_nTileCols; }
+	int Rows() const noexcept { return m_nRows; }
+	int Cols() const noexcept { return m_nCols; }
+
+	/* Version of the source grid when published */
+	unsigned int Version() const noexcept { return m_nVersion; }
+
+protected:
+	std::vector<GridTilePtr>	m_vecTiles;
+	int							m_nTileCols{ 0 };
+	int							m_nRows{ 0 };
+	int							m_nCols{ 0 };
+	unsigned int				m_nVersion{ 0 };
+};
+
+typedef std::shared_ptr<const GridPFSnapshot> GridPFSnapshotPtr;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFSnapshots class
+
+/*
+* Follows a GridPF as a listener : SetData on the editor thread writes the
+* cell to the working tiles, a tile still shared with a published snapshot
+* is copied first (one tile per edited tile, once per publish). Publish()
+* makes the working tiles the current snapshot : a vector of tile pointers,
+* no cell is copied. Readers pin a snapshot with Acquire() (one atomic
+* shared pointer load) and read it without any lock, the snapshot stays
+* alive as long as they hold it.
+* Threads : edits and Publish() on the editor thread, Acquire() anywhere.
+*/
+class GridPFSnapshots : public GridPFListener
+{
+public:
+	GridPFSnapshots() = default;
+	GridPFSnapshots(const GridPFSnapshots&) = delete;
+	GridPFSnapshots& operator=(const GridPFSnapshots&) = delete;
+
+	~GridPFSnapshots()
+	{
+		Detach();
+	}
+
+	/* Follow the grid and publish its current state */
+	void Attach(GridPF* pGridBoard)
+	{
+		Detach();
+
+		m_pGridBoard = pGridBoard;
+		if (!m_pGridBoard)
+			return;
+
+		m_pGridBoard->AddListener(this);
+		OnGridRebuilt(m_pGridBoard);
+		Publish();
+	}
+
+	void Detach()
+	{
+		if (m_pGridBoard)
+			m_pGridBoard->RemoveListener(this);
+
+		m_pGridBoard = nullptr;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Make the edits done so far visible to the readers
+	*! @return : the published snapshot
+	*******************************************************************************/
+	GridPFSnapshotPtr Publish()
+	{
+		std::shared_ptr<GridPFSnapshot> pSnapshot = std::make_shared<GridPFSnapshot>();
+		pSnapshot->m_vecTiles.assign(m_vecTiles.begin(), m_vecTiles.end());
+		pSnapshot->m_nTileCols = m_nTileCols;
+		pSnapshot->m_nRows = m_nRows;
+		pSnapshot->m_nCols = m_nCols;
+		pSnapshot->m_nVersion = m_pGridBoard ? m_pGridBoard->Version() : 0;
+
+		// every working tile is shared from now on
+		std::fill(m_vecOwned.begin(), m_vecOwned.end(), uint8_t(0));
+
+		GridPFSnapshotPtr pPublished = pSnapshot;
+		std::atomic_store(&m_pCurrent, pPublished);
+
+		return pPublished;
+	}
+
+	/* Latest published snapshot, null before the first Attach */
+	GridPFSnapshotPtr Acquire() const
+	{
+		return std::atomic_load(&m_pCurrent);
+	}
+
+	/* Tiles copied since the last publish */
+	size_t DirtyTiles() const noexcept
+	{
+		return size_t(std::count(m_vecOwned.begin(), m_vecOwned.end(), uint8_t(1)));
+	}
+
+public:
+	virtual void OnGridRebuilt(GridPF* pGridBoard)
+	{
+		m_nRows = pGridBoard->Rows();
+		m_nCols = pGridBoard->Cols();
+		m_nTileCols = (m_nCols + GRIDSNAPSHOT_TILE - 1) / GRIDSNAPSHOT_TILE;
+		int nTileRows = (m_nRows + GRIDSNAPSHOT_TILE - 1) / GRIDSNAPSHOT_TILE;
+
+		m_vecTiles.assign(size_t(m_nTileCols) * nTileRows, nullptr);
+		m_vecOwned.assign(m_vecTiles.size(), 1);
+
+		for (int ty = 0; ty < nTileRows; ty++)
+		{
+			for (int tx = 0; tx < m_nTileCols; tx++)
+			{
+				std::shared_ptr<stGridTilePF> pTile = std::make_shared<stGridTilePF>();
+
+				int nMaxX = std::min(GRIDSNAPSHOT_TILE, m_nCols - tx * GRIDSNAPSHOT_TILE);
+				int nMaxY = std::min(GRIDSNAPSHOT_TILE, m_nRows - ty * GRIDSNAPSHOT_TILE);
+
+				for (int y = 0; y < nMaxY; y++)
+				{
+					for (int x = 0; x < nMaxX; x++)
+					{
+						stCellPF* pCell = pGridBoard->Get(tx * GRIDSNAPSHOT_TILE + x, ty * GRIDSNAPSHOT_TILE + y);
+						if (pCell)
+							pTile->arData[x + y * GRIDSNAPSHOT_TILE] = pCell->stData;
+					}
+				}
+
+				m_vecTiles[tx + size_t(ty) * m_nTileCols] = pTile;
+			}
+		}
+	}
+
+	virtual void OnCellChanged(GridPF* pGridBoard, const int x, const int y)
+	{
+		stCellPF* pCell = pGridBoard->Get(x, y);
+		if (!pCell)
+			return;
+
+		size_t nTile = size_t(x / GRIDSNAPSHOT_TILE) + size_t(y / GRIDSNAPSHOT_TILE) * m_nTileCols;
+
+		// copy on write : the published snapshots keep the old tile
+		if (!m_vecOwned[nTile])
+		{
+			m_vecTiles[nTile] = std::make_shared<stGridTilePF>(*m_vecTiles[nTile]);
+			m_vecOwned[nTile] = 1;
+		}
+
+		m_vecTiles[nTile]->arData[(x % GRIDSNAPSHOT_TILE) + (y % GRIDSNAPSHOT_TILE) * GRIDSNAPSHOT_TILE] = pCell->stData;
+	}
+
+protected:
+	GridPF*										m_pGridBoard{ nullptr };
+
+	// working tiles (editor thread)
+	std::vector<std::shared_ptr<stGridTilePF>>	m_vecTiles;
+	std::vector<uint8_t>						m_vecOwned;		// 1 : not in any snapshot, written in place
+	int											m_nTileCols{ 0 };
+	int											m_nRows{ 0 };
+	int											m_nCols{ 0 };
+
+	GridPFSnapshotPtr							m_pCurrent;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// GridPFReplica class
+
+/*
+* Private GridPF of a reader thread for the strategies, which all search a
+* GridPF. Sync() brings it to a snapshot : tiles with the same pointer as
+* the last synced snapshot are skipped, the others are written cell by cell
+* through SetData (only the cells that differ) so the strategy caches and
+* the grid listeners see normal edits. The last synced snapshot is held to
+* compare the tiles.
+*/
+class GridPFReplica
+{
+public:
+	GridPF* Grid() noexcept
+	{
+		return &m_Grid;
+	}
+
+	const GridPFSnapshotPtr& Snapshot() const noexcept
+	{
+		return m_pSynced;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Make the grid equal to the snapshot
+	*! @return : number of cells written
+	*******************************************************************************/
+	size_t Sync(const GridPFSnapshotPtr& pSnapshot)
+	{
+		if (!pSnapshot || pSnapshot == m_pSynced)
+			return 0;
+
+		size_t szWritten = 0;
+
+		if (!m_pSynced || m_pSynced->Rows() != pSnapshot->Rows() || m_pSynced->Cols() != pSnapshot->Cols())
+		{
+			std::vector<stCellDataPF> vecData(size_t(pSnapshot->Rows()) * pSnapshot->Cols());
+
+			for (int y = 0; y < pSnapshot->Rows(); y++)
+			{
+				for (int x = 0; x < pSnapshot->Cols(); x++)
+					vecData[x + size_t(y) * pSnapshot->Cols()] = *pSnapshot->Get(x, y);
+			}
+
+			m_Grid.BuildFrom(vecData, pSnapshot->Rows(), pSnapshot->Cols());
+			szWritten = vecData.size();
+		}
+		else
+		{
+			for (size_t nTile = 0; nTile < pSnapshot->TileCount(); nTile++)
+			{
+				if (pSnapshot->Tile(nTile) != m_pSynced->Tile(nTile))
+					szWritten += SyncTile(*pSnapshot, nTile);
+			}
+		}
+
+		m_pSynced = pSnapshot;
+
+		return szWritten;
+	}
+
+protected:
+	size_t SyncTile(const GridPFSnapshot& snapshot, const size_t nTile)
+	{
+		const stGridTilePF& tile = *snapshot.Tile(nTile);
+
+		int nX0 = int(nTile % snapshot.TileCols()) * GRIDSNAPSHOT_TILE;
+		int nY0 = int(nTile / snapshot.TileCols()) * GRIDSNAPSHOT_TILE;
+		int nMaxX = std::min(GRIDSNAPSHOT_TILE, snapshot.Cols() - nX0);
+		int nMaxY = std::min(GRIDSNAPSHOT_TILE, snapshot.Rows() - nY0);
+
+		size_t szWritten = 0;
+
+		for (int y = 0; y < nMaxY; y++)
+		{
+			for (int x = 0; x < nMaxX; x++)
+			{
+				stCellDataPF data = tile.arData[x + y * GRIDSNAPSHOT_TILE];
+				stCellPF* pCell = m_Grid.Get(nX0 + x, nY0 + y);
+
+				if (pCell->stData.fWeight != data.fWeight || pCell->stData.pData != data.pData)
+				{
+					m_Grid.SetData(nX0 + x, nY0 + y, data);
+					szWritten++;
+				}
+			}
+		}
+
+		return szWritten;
+	}
+
+protected:
+	GridPF						m_Grid;
+	GridPFSnapshotPtr			m_pSynced;
+};
+
+#endif // !XGRIDSNAPSHOT_H
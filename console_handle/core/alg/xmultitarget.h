@@ -0,0 +1,333 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Nearest of many targets (and k nearest) in one search
+* @file  : xmultitarget.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XMULTITARGET_H
+#define XMULTITARGET_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <float.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+
+#define MULTITARGET_NONE		UINT32_MAX
+#define MULTITARGET_EXACT_H		16		// up to this count : min over the targets heuristic
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stTargetPath
+{
+	stCellIdxPF				stTarget;
+	size_t					nIndex{ 0 };		// position in the target list
+	float					fCost{ 0.f };
+	std::vector<stCellPF*>	vecPath;			// start -> target
+} stTargetPathPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// MultiTargetSearch class
+
+/*
+* One a-star from the start toward a set of targets kept as a bitmap of the
+* board. Heuristic : octile distance to the nearest target when they are few,
+* to their bounding box otherwise. Both are consistent and zero on a target,
+* so the targets are popped in increasing path cost : the first one is the
+* nearest, the k first ones are the k nearest.
+* Moves follow the a-star rules (cross, dont cross corners).
+*/
+class MultiTargetSearch
+{
+	typedef struct _stMultiTargetNode
+	{
+		float		fCost{ -1.f };		// < 0 : not reached
+		uint32_t	nPrev{ MULTITARGET_NONE };
+		uint32_t	nGeneration{ 0 };
+		bool		bClosed{ false };
+	} stMultiTargetNodePF;
+
+	typedef struct _stMultiTargetOpen
+	{
+		float		fScore{ 0.f };
+		float		fCost{ 0.f };
+		uint32_t	nIdx{ 0 };
+
+		bool operator<(const _stMultiTargetOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stMultiTargetOpenPF;
+
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Paths to the nCount nearest reachable targets, nearest first
+	*! @param  : [in] vecTargets : blocked / outside targets are ignored, duplicates
+	*!           are reported once (first position)
+	*! @return : number of paths in vecResult
+	*******************************************************************************/
+	size_t Search(GridPF* pGridBoard, stCellIdxPF start, const std::vector<stCellIdxPF>& vecTargets,
+				  std::vector<stTargetPathPF>& vecResult, const size_t nCount = 1)
+	{
+		vecResult.clear();
+
+		if (!pGridBoard || nCount == 0 || !IsFree(pGridBoard, start.nX, start.nY))
+			return 0;
+
+		Prepare(pGridBoard);
+
+		size_t szTargets = MarkTargets(pGridBoard, vecTargets);
+		if (szTargets > 0)
+			Run(pGridBoard, start, vecTargets, vecResult, std::min(nCount, szTargets));
+
+		// Leave the bitmap clean
+		for (auto& stTarget : vecTargets)
+		{
+			if (IsInside(pGridBoard, stTarget.nX, stTarget.nY))
+				ClearTarget(CellIndex(pGridBoard, stTarget.nX, stTarget.nY));
+		}
+
+		return vecResult.size();
+	}
+
+	/* Path to the nearest reachable target, empty if none */
+	std::vector<stCellPF*> Nearest(GridPF* pGridBoard, stCellIdxPF start, const std::vector<stCellIdxPF>& vecTargets)
+	{
+		std::vector<stTargetPathPF> vecResult;
+		if (Search(pGridBoard, start, vecTargets, vecResult, 1) == 0)
+			return std::vector<stCellPF*>();
+
+		return std::move(vecResult[0].vecPath);
+	}
+
+protected:
+	static bool IsInside(GridPF* pGridBoard, const int x, const int y) noexcept
+	{
+		return x >= 0 && y >= 0 && x < pGridBoard->Cols() && y < pGridBoard->Rows();
+	}
+
+	static uint32_t CellIndex(GridPF* pGridBoard, const int x, const int y) noexcept
+	{
+		return uint32_t(x + size_t(y) * pGridBoard->Cols());
+	}
+
+	static bool IsFree(GridPF* pGridBoard, const int x, const int y) noexcept
+	{
+		if (!IsInside(pGridBoard, x, y))
+			return false;
+
+		stCellPF* pCell = pGridBoard->Get(x, y);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	bool IsTarget(const uint32_t n) const noexcept
+	{
+		return (m_vecTargetBits[n >> 6] >> (n & 63)) & 1;
+	}
+
+	void ClearTarget(const uint32_t n) noexcept
+	{
+		m_vecTargetBits[n >> 6] &= ~(uint64_t(1) << (n & 63));
+	}
+
+	static float Octile(const int dx, const int dy) noexcept
+	{
+		return 1.f * std::abs(dx - dy) + 1.412f * std::min(dx, dy);
+	}
+
+	void Prepare(GridPF* pGridBoard)
+	{
+		size_t szLength = size_t(pGridBoard->Cols()) * pGridBoard->Rows();
+
+		// The bitmap is left clean by every search
+		if (m_vecTargetBits.size() < (szLength + 63) / 64)
+			m_vecTargetBits.assign((szLength + 63) / 64, 0);
+
+		m_Nodes.Begin(szLength);
+	}
+
+	/* Bitmap + heuristic data, return the number of distinct free targets */
+	size_t MarkTargets(GridPF* pGridBoard, const std::vector<stCellIdxPF>& vecTargets)
+	{
+		size_t szCount = 0;
+		m_vecExact.clear();
+
+		for (auto& stTarget : vecTargets)
+		{
+			if (!IsFree(pGridBoard, stTarget.nX, stTarget.nY))
+				continue;
+
+			uint32_t n = CellIndex(pGridBoard, stTarget.nX, stTarget.nY);
+			if (IsTarget(n))
+				continue;
+
+			m_vecTargetBits[n >> 6] |= uint64_t(1) << (n & 63);
+
+			if (szCount == 0)
+			{
+				m_nMinX = m_nMaxX = stTarget.nX;
+				m_nMinY = m_nMaxY = stTarget.nY;
+			}
+			else
+			{
+				m_nMinX = std::min(m_nMinX, stTarget.nX);
+				m_nMaxX = std::max(m_nMaxX, stTarget.nX);
+				m_nMinY = std::min(m_nMinY, stTarget.nY);
+				m_nMaxY = std::max(m_nMaxY, stTarget.nY);
+			}
+
+			if (szCount < MULTITARGET_EXACT_H)
+				m_vecExact.push_back(stTarget);
+
+			szCount++;
+		}
+
+		if (szCount > MULTITARGET_EXACT_H)
+			m_vecExact.clear();
+
+		return szCount;
+	}
+
+	float Heuristic(const int x, const int y) const noexcept
+	{
+		if (!m_vecExact.empty())
+		{
+			float fMin = FLT_MAX;
+			for (auto& stTarget : m_vecExact)
+				fMin = std::min(fMin, Octile(std::abs(x - stTarget.nX), std::abs(y - stTarget.nY)));
+
+			return fMin;
+		}
+
+		int dx = std::max(std::max(m_nMinX - x, x - m_nMaxX), 0);
+		int dy = std::max(std::max(m_nMinY - y, y - m_nMaxY), 0);
+
+		return Octile(dx, dy);
+	}
+
+	bool CanMove(GridPF* pGridBoard, const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(pGridBoard, x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		bool bSide1 = IsFree(pGridBoard, x + dx, y);
+		bool bSide2 = IsFree(pGridBoard, x, y + dy);
+
+		return m_Option.m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+	void Run(GridPF* pGridBoard, stCellIdxPF start, const std::vector<stCellIdxPF>& vecTargets,
+			 std::vector<stTargetPathPF>& vecResult, const size_t nCount)
+	{
+		const int nCols = pGridBoard->Cols();
+		const int nDirs = m_Option.m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		m_Open.Clear();
+
+		uint32_t nStart = CellIndex(pGridBoard, start.nX, start.nY);
+		m_Nodes.Get(nStart).fCost = 0.f;
+		m_Open.Push({ Heuristic(start.nX, start.nY), 0.f, nStart });
+
+		while (!m_Open.Empty())
+		{
+			stMultiTargetOpenPF stOpen = m_Open.Pop();
+
+			stMultiTargetNodePF& node = m_Nodes[stOpen.nIdx];
+			if (node.bClosed || stOpen.fCost > node.fCost)
+				continue;
+
+			node.bClosed = true;
+
+			int x = int(stOpen.nIdx % nCols);
+			int y = int(stOpen.nIdx / nCols);
+
+			if (IsTarget(stOpen.nIdx))
+			{
+				ClearTarget(stOpen.nIdx);
+				AddResult(pGridBoard, stOpen.nIdx, vecTargets, vecResult);
+
+				if (vecResult.size() >= nCount)
+					break;
+			}
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				int dx = arDir[d][0], dy = arDir[d][1];
+				if (!CanMove(pGridBoard, x, y, dx, dy))
+					continue;
+
+				uint32_t nNext = CellIndex(pGridBoard, x + dx, y + dy);
+				float fCost = node.fCost + (d < 4 ? 1.f : 1.412f);
+
+				stMultiTargetNodePF& next = m_Nodes.Get(nNext);
+				if (next.bClosed || (next.fCost >= 0.f && next.fCost <= fCost))
+					continue;
+
+				next.fCost = fCost;
+				next.nPrev = stOpen.nIdx;
+
+				m_Open.Push({ fCost + Heuristic(x + dx, y + dy), fCost, nNext });
+			}
+		}
+	}
+
+	void AddResult(GridPF* pGridBoard, const uint32_t nIdx, const std::vector<stCellIdxPF>& vecTargets,
+				   std::vector<stTargetPathPF>& vecResult)
+	{
+		const int nCols = pGridBoard->Cols();
+
+		stTargetPathPF result;
+		result.stTarget = { int(nIdx % nCols), int(nIdx / nCols) };
+		result.fCost = m_Nodes[nIdx].fCost;
+
+		for (size_t i = 0; i < vecTargets.size(); i++)
+		{
+			if (vecTargets[i].nX == result.stTarget.nX && vecTargets[i].nY == result.stTarget.nY)
+			{
+				result.nIndex = i;
+				break;
+			}
+		}
+
+		for (uint32_t n = nIdx; n != MULTITARGET_NONE; n = m_Nodes[n].nPrev)
+			result.vecPath.push_back(pGridBoard->Get(int(n % nCols), int(n / nCols)));
+
+		std::reverse(result.vecPath.begin(), result.vecPath.end());
+		vecResult.push_back(std::move(result));
+	}
+
+protected:
+	PathFinderOption					m_Option;
+
+	// targets
+	std::vector<uint64_t>				m_vecTargetBits;
+	std::vector<stCellIdxPF>			m_vecExact;
+	int									m_nMinX{ 0 };
+	int									m_nMaxX{ 0 };
+	int									m_nMinY{ 0 };
+	int									m_nMaxY{ 0 };
+
+	// search
+	SearchRecords<stMultiTargetNodePF>	m_Nodes;
+	SearchOpenList<stMultiTargetOpenPF>	m_Open;
+};
+
+#endif // !XMULTITARGET_H
@@ -0,0 +1,425 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Batch of path requests, one reverse search per distinct target
+* @file  : xpathbatch.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XPATHBATCH_H
+#define XPATHBATCH_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <float.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define PATHBATCH_NONE			UINT32_MAX
+#define PATHBATCH_EXACT_H		16		// up to this count : min over the starts heuristic
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stBatchRequest
+{
+	stCellIdxPF		stStart;
+	stCellIdxPF		stTarget;
+} stBatchRequestPF;
+
+typedef struct _stBatchPath
+{
+	float					fCost{ 0.f };
+	std::vector<stCellPF*>	vecPath;		// start -> target, empty if none
+} stBatchPathPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// TargetTree class
+
+/*
+* Search grown from a target toward a set of starts : the moves of a-star
+* (1 / 1.412, cross, dont cross corners) are symmetric between free cells,
+* so the tree of parents leads every settled cell to the target on a
+* shortest path. It is a Dijkstra ordered by the octile distance to the
+* nearest start (to the box of the starts when they are many) : consistent,
+* so each start is settled with its exact cost, and it stops once all the
+* starts are settled instead of covering the board.
+* Scratch : 12 bytes per cell, reused between targets.
+*/
+class TargetTree
+{
+	typedef struct _stTreeNode
+	{
+		float		fCost{ FLT_MAX };
+		uint32_t	nNext{ PATHBATCH_NONE };	// parent, one step closer to the target
+		uint32_t	nGeneration{ 0 };
+	} stTreeNodePF;
+
+	typedef struct _stTreeOpen
+	{
+		float		fScore{ 0.f };
+		float		fCost{ 0.f };
+		uint32_t	nIdx{ 0 };
+
+		bool operator<(const _stTreeOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stTreeOpenPF;
+
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Paths of all the starts to one target
+	*! @param  : [out] vecOut : vecOut[i] path of vecStarts[i] (start -> target)
+	*! @return : number of starts reached
+	*******************************************************************************/
+	size_t Search(GridPF* pGridBoard, stCellIdxPF target, const std::vector<stCellIdxPF>& vecStarts,
+				  std::vector<stBatchPathPF>& vecOut)
+	{
+		vecOut.assign(vecStarts.size(), stBatchPathPF());
+
+		if (!pGridBoard || !IsFree(pGridBoard, target.nX, target.nY))
+			return 0;
+
+		m_pGridBoard = pGridBoard;
+		Prepare();
+
+		size_t szWaiting = MarkStarts(vecStarts);
+		if (szWaiting > 0)
+			Grow(target, szWaiting);
+
+		size_t szReached = 0;
+		for (size_t i = 0; i < vecStarts.size(); i++)
+		{
+			if (IsFree(pGridBoard, vecStarts[i].nX, vecStarts[i].nY) && MakePath(vecStarts[i], vecOut[i]))
+				szReached++;
+		}
+
+		return szReached;
+	}
+
+	/* Scratch bytes held by this instance */
+	size_t MemorySize() const noexcept
+	{
+		return m_Nodes.MemorySize() + m_Open.MemorySize() + m_vecStartBits.capacity() * sizeof(uint64_t);
+	}
+
+protected:
+	static bool IsFree(GridPF* pGridBoard, const int x, const int y) noexcept
+	{
+		if (x < 0 || y < 0 || x >= pGridBoard->Cols() || y >= pGridBoard->Rows())
+			return false;
+
+		stCellPF* pCell = pGridBoard->Get(x, y);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(m_pGridBoard, x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		bool bSide1 = IsFree(m_pGridBoard, x + dx, y);
+		bool bSide2 = IsFree(m_pGridBoard, x, y + dy);
+
+		return m_Option.m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+	static float Octile(const int dx, const int dy) noexcept
+	{
+		return 1.f * std::abs(dx - dy) + 1.412f * std::min(dx, dy);
+	}
+
+	uint32_t CellIndex(const int x, const int y) const noexcept
+	{
+		return uint32_t(x + size_t(y) * m_pGridBoard->Cols());
+	}
+
+	void Prepare()
+	{
+		size_t szLength = size_t(m_pGridBoard->Cols()) * m_pGridBoard->Rows();
+
+		// The bitmap is left clean by every batch
+		if (m_vecStartBits.size() < (szLength + 63) / 64)
+			m_vecStartBits.assign((szLength + 63) / 64, 0);
+
+		m_Nodes.Begin(szLength);
+	}
+
+	bool IsStart(const uint32_t n) const noexcept
+	{
+		return (m_vecStartBits[n >> 6] >> (n & 63)) & 1;
+	}
+
+	/* Bitmap + heuristic data, return the number of distinct free starts */
+	size_t MarkStarts(const std::vector<stCellIdxPF>& vecStarts)
+	{
+		size_t szCount = 0;
+		m_vecExact.clear();
+
+		for (auto& stStart : vecStarts)
+		{
+			if (!IsFree(m_pGridBoard, stStart.nX, stStart.nY))
+				continue;
+
+			uint32_t n = CellIndex(stStart.nX, stStart.nY);
+			if (IsStart(n))
+				continue;
+
+			m_vecStartBits[n >> 6] |= uint64_t(1) << (n & 63);
+
+			if (szCount == 0)
+			{
+				m_nMinX = m_nMaxX = stStart.nX;
+				m_nMinY = m_nMaxY = stStart.nY;
+			}
+			else
+			{
+				m_nMinX = std::min(m_nMinX, stStart.nX);
+				m_nMaxX = std::max(m_nMaxX, stStart.nX);
+				m_nMinY = std::min(m_nMinY, stStart.nY);
+				m_nMaxY = std::max(m_nMaxY, stStart.nY);
+			}
+
+			if (szCount < PATHBATCH_EXACT_H)
+				m_vecExact.push_back(stStart);
+
+			szCount++;
+		}
+
+		if (szCount > PATHBATCH_EXACT_H)
+			m_vecExact.clear();
+
+		return szCount;
+	}
+
+	float Heuristic(const int x, const int y) const noexcept
+	{
+		if (!m_vecExact.empty())
+		{
+			float fMin = FLT_MAX;
+			for (auto& stStart : m_vecExact)
+				fMin = std::min(fMin, Octile(std::abs(x - stStart.nX), std::abs(y - stStart.nY)));
+
+			return fMin;
+		}
+
+		int dx = std::max(std::max(m_nMinX - x, x - m_nMaxX), 0);
+		int dy = std::max(std::max(m_nMinY - y, y - m_nMaxY), 0);
+
+		return Octile(dx, dy);
+	}
+
+	/* Settle cells from the target until szWaiting starts are reached, clears their bits */
+	void Grow(stCellIdxPF target, size_t szWaiting)
+	{
+		const int nCols = m_pGridBoard->Cols();
+		const int nDirs = m_Option.m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		m_Open.Clear();
+
+		uint32_t nTarget = CellIndex(target.nX, target.nY);
+		m_Nodes.Get(nTarget).fCost = 0.f;
+		m_Open.Push({ Heuristic(target.nX, target.nY), 0.f, nTarget });
+
+		while (!m_Open.Empty())
+		{
+			stTreeOpenPF stOpen = m_Open.Pop();
+
+			stTreeNodePF& node = m_Nodes[stOpen.nIdx];
+			if (stOpen.fCost > node.fCost)
+				continue;
+
+			if (IsStart(stOpen.nIdx))
+			{
+				m_vecStartBits[stOpen.nIdx >> 6] &= ~(uint64_t(1) << (stOpen.nIdx & 63));
+				if (--szWaiting == 0)
+					break;
+			}
+
+			int x = int(stOpen.nIdx % nCols);
+			int y = int(stOpen.nIdx / nCols);
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				int dx = arDir[d][0], dy = arDir[d][1];
+				if (!CanMove(x, y, dx, dy))
+					continue;
+
+				uint32_t nNext = CellIndex(x + dx, y + dy);
+				float fCost = node.fCost + (d < 4 ? 1.f : 1.412f);
+
+				stTreeNodePF& next = m_Nodes.Get(nNext);
+				if (next.fCost <= fCost)
+					continue;
+
+				next.fCost = fCost;
+				next.nNext = stOpen.nIdx;
+
+				m_Open.Push({ fCost + Heuristic(x + dx, y + dy), fCost, nNext });
+			}
+		}
+
+		// starts never reached
+		if (szWaiting > 0)
+			std::fill(m_vecStartBits.begin(), m_vecStartBits.end(), 0);
+	}
+
+	/* Walk the tree from the start up to the target */
+	bool MakePath(stCellIdxPF start, stBatchPathPF& result) const
+	{
+		const int nCols = m_pGridBoard->Cols();
+		uint32_t nStart = CellIndex(start.nX, start.nY);
+
+		if (!m_Nodes.IsCurrent(nStart))
+			return false;
+
+		const stTreeNodePF& node = m_Nodes[nStart];
+
+		result.fCost = node.fCost;
+
+		for (uint32_t n = nStart; n != PATHBATCH_NONE; n = m_Nodes[n].nNext)
+			result.vecPath.push_back(m_pGridBoard->Get(int(n % nCols), int(n / nCols)));
+
+		return true;
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	GridPF*						m_pGridBoard{ nullptr };
+
+	SearchRecords<stTreeNodePF>	m_Nodes;
+	SearchOpenList<stTreeOpenPF>	m_Open;
+	std::vector<uint64_t>		m_vecStartBits;
+
+	// heuristic
+	std::vector<stCellIdxPF>	m_vecExact;
+	int							m_nMinX{ 0 };
+	int							m_nMaxX{ 0 };
+	int							m_nMinY{ 0 };
+	int							m_nMaxY{ 0 };
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// PathBatch class
+
+/*
+* Requests of a tick grouped by target : one TargetTree per distinct
+* target, the groups split over threads (one tree scratch per thread kept
+* between batches). The work follows the distinct targets, not the requests.
+*/
+class PathBatch
+{
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/*******************************************************************************
+	*! @brief  : vecOut[i] = path of vecRequests[i]
+	*! @param  : [in] nThreads : 0 = all hardware threads
+	*! @return : number of distinct targets searched
+	*******************************************************************************/
+	size_t Solve(GridPF* pGridBoard, const std::vector<stBatchRequestPF>& vecRequests,
+				 std::vector<stBatchPathPF>& vecOut, const unsigned int nThreads = 0)
+	{
+		vecOut.assign(vecRequests.size(), stBatchPathPF());
+
+		if (!pGridBoard || vecRequests.empty())
+			return 0;
+
+		Group(pGridBoard, vecRequests);
+
+		size_t szGroups = m_vecGroupBegin.size() - 1;
+
+		unsigned int nWorkers = util::thread_count(nThreads);
+		if (m_vecWorkers.size() < nWorkers)
+			m_vecWorkers.resize(nWorkers);
+
+		for (auto& worker : m_vecWorkers)
+			worker.SetOption(m_Option);
+
+		util::parallel_for(0, szGroups, [&](size_t nBegin, size_t nEnd, unsigned int t)
+		{
+			TargetTree& worker = m_vecWorkers[t];
+			std::vector<stCellIdxPF> vecStarts;
+			std::vector<stBatchPathPF> vecPaths;
+
+			for (size_t g = nBegin; g < nEnd; g++)
+			{
+				vecStarts.clear();
+				for (uint32_t i = m_vecGroupBegin[g]; i < m_vecGroupBegin[g + 1]; i++)
+					vecStarts.push_back(vecRequests[m_vecOrder[i]].stStart);
+
+				worker.Search(pGridBoard, vecRequests[m_vecOrder[m_vecGroupBegin[g]]].stTarget, vecStarts, vecPaths);
+
+				for (uint32_t i = m_vecGroupBegin[g]; i < m_vecGroupBegin[g + 1]; i++)
+					vecOut[m_vecOrder[i]] = std::move(vecPaths[i - m_vecGroupBegin[g]]);
+			}
+		}, nWorkers);
+
+		return szGroups;
+	}
+
+protected:
+	/* Requests ordered by target, one group per target (outside targets dropped) */
+	void Group(GridPF* pGridBoard, const std::vector<stBatchRequestPF>& vecRequests)
+	{
+		const int nCols = pGridBoard->Cols(), nRows = pGridBoard->Rows();
+
+		auto funKey = [nCols](const stCellIdxPF& stIdx)
+		{
+			return uint64_t(stIdx.nX) + uint64_t(stIdx.nY) * uint64_t(nCols);
+		};
+
+		m_vecOrder.clear();
+		for (uint32_t i = 0; i < uint32_t(vecRequests.size()); i++)
+		{
+			const stCellIdxPF& stTarget = vecRequests[i].stTarget;
+			if (stTarget.nX >= 0 && stTarget.nY >= 0 && stTarget.nX < nCols && stTarget.nY < nRows)
+				m_vecOrder.push_back(i);
+		}
+
+		std::sort(m_vecOrder.begin(), m_vecOrder.end(), [&](uint32_t a, uint32_t b)
+		{
+			uint64_t nKeyA = funKey(vecRequests[a].stTarget), nKeyB = funKey(vecRequests[b].stTarget);
+			return nKeyA < nKeyB || (nKeyA == nKeyB && a < b);
+		});
+
+		m_vecGroupBegin.clear();
+		for (uint32_t i = 0; i < uint32_t(m_vecOrder.size()); i++)
+		{
+			if (i == 0 || funKey(vecRequests[m_vecOrder[i]].stTarget) != funKey(vecRequests[m_vecOrder[i - 1]].stTarget))
+				m_vecGroupBegin.push_back(i);
+		}
+
+		m_vecGroupBegin.push_back(uint32_t(m_vecOrder.size()));
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	std::vector<TargetTree>		m_vecWorkers;
+
+	std::vector<uint32_t>		m_vecOrder;			// request indices by target
+	std::vector<uint32_t>		m_vecGroupBegin;	// first of each group in m_vecOrder, + end
+};
+
+#endif // !XPATHBATCH_H
@@ -11,15 +11,68 @@
 #ifndef XPATH_FINDER
 #define XPATH_FINDER
 
+#include <stdint.h>
 #include "xgridpf.h"
+#include "com/xtimer.h"
 #include "alg/xastar.h"
 
 struct PathFinderOption
 {
 	bool m_bDontCrossCorners{ false };
 	bool m_bAllowCross{ true };
+
+	float m_fAgentRadius{ 0.f };		// cells, needs a clearance map on the strategy
+
+	bool m_bCollectStats{ false };	// fill stSearchStatsPF for each query
+	bool m_bRecordEvents{ false };	// record push/pop/decrease-key events
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Search statistics
+
+typedef struct _stSearchStats
+{
+	unsigned int nExpanded{ 0 };		// cells popped from the open list
+	unsigned int nPushes{ 0 };			// cells inserted into the open list
+	unsigned int nDecreaseKeys{ 0 };	// cost improvements of an opened cell
+	unsigned int nMaxOpenSize{ 0 };		// peak size of the open list
+	unsigned int nLosChecks{ 0 };		// line of sight tests (theta-star)
+	double		 dWallTime{ 0.0 };		// milliseconds
+} stSearchStatsPF;
+
+enum SearchEventType : unsigned char
+{
+	SearchEventPush,
+	SearchEventPop,
+	SearchEventDecreaseKey,
+};
+
+typedef struct _stSearchEvent
+{
+	SearchEventType eType{ SearchEventPush };
+	stCellIdxPF		stIdx;
+} stSearchEventPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Step-wise search
+
+enum SearchState
+{
+	SearchIdle,
+	SearchRunning,
+	SearchFound,
+	SearchNotFound,
 };
 
+typedef struct _stSearchProgress
+{
+	size_t	nExpanded{ 0 };		// cells expanded since begin
+	size_t	nOpenSize{ 0 };		// current size of the open list
+	float	fProgress{ 0.f };	// [0, 1] closest approach to the target
+} stSearchProgressPF;
+
 /////////////////////////////////////////////////////////////////////////////////////
 /***********************************************************************************/
 // PathFinding class
@@ -27,19 +80,280 @@ struct PathFinderOption
 class PathFinding
 {
 public:
+	virtual ~PathFinding() = default;
+
 	virtual void SetOption(PathFinderOption* pOption) noexcept
 	{
 		pRefOption = pOption;
 	}
 
+	const stSearchStatsPF& GetStats() const noexcept
+	{
+		return m_Stats;
+	}
+
+	const std::vector<stSearchEventPF>& GetEvents() const noexcept
+	{
+		return m_vecEvents;
+	}
+
 protected:
 	virtual void Reset() = 0;
 	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target) = 0;
 
+protected:
+	/*
+	* Step-wise search : strategies without incremental support run the whole
+	* search on the first step
+	*/
+	virtual bool SearchBegin(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		m_pSearchGrid = pGridBoard;
+		m_stSearchStart = start;
+		m_stSearchEnd = target;
+		m_vecSearchPath.clear();
+		m_eSearchState = pGridBoard ? SearchRunning : SearchNotFound;
+
+		return m_eSearchState == SearchRunning;
+	}
+
+	virtual size_t SearchStep(size_t nMaxExpansions)
+	{
+		if (m_eSearchState != SearchRunning || nMaxExpansions == 0)
+			return 0;
+
+		m_vecSearchPath = Execute(m_pSearchGrid, m_stSearchStart, m_stSearchEnd);
+		m_eSearchState = m_vecSearchPath.empty() ? SearchNotFound : SearchFound;
+
+		return 1;
+	}
+
+	virtual std::vector<stCellPF*> SearchPath()
+	{
+		return m_vecSearchPath;
+	}
+
+	/*
+	* Return the path length, the buffer is filled only when it is large enough
+	*/
+	virtual size_t SearchPath(stCellPF** pBuffer, size_t szCapacity)
+	{
+		if (m_eSearchState != SearchFound)
+			return 0;
+
+		if (pBuffer && m_vecSearchPath.size() <= szCapacity)
+			std::copy(m_vecSearchPath.begin(), m_vecSearchPath.end(), pBuffer);
+
+		return m_vecSearchPath.size();
+	}
+
+	virtual void SearchProgress(stSearchProgressPF& progress)
+	{
+		progress.nExpanded = 0;
+		progress.nOpenSize = 0;
+		progress.fProgress = (m_eSearchState == SearchFound) ? 1.f : 0.f;
+	}
+
+	SearchState GetSearchState() const noexcept
+	{
+		return m_eSearchState;
+	}
+
+	/*
+	* Path output into caller memory : no allocation once the buffer is warm
+	*/
+	size_t ExecuteInto(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target,
+					   stCellPF** pBuffer, size_t szCapacity)
+	{
+		if (!SearchBegin(pGridBoard, start, target))
+			return 0;
+
+		while (SearchStep(SIZE_MAX) > 0);
+
+		return SearchPath(pBuffer, szCapacity);
+	}
+
+	size_t ExecuteInto(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target,
+					   std::vector<stCellPF*>& vecPath)
+	{
+		vecPath.clear();
+
+		if (!SearchBegin(pGridBoard, start, target))
+			return 0;
+
+		while (SearchStep(SIZE_MAX) > 0);
+
+		vecPath.resize(SearchPath(nullptr, 0));
+
+		return SearchPath(vecPath.data(), vecPath.size());
+	}
+
+protected:
+	/*
+	* Statistics hooks : only a flag test when stats/events are disabled
+	*/
+	void StatsBegin()
+	{
+		m_bStats  = pRefOption && pRefOption->m_bCollectStats;
+		m_bEvents = pRefOption && pRefOption->m_bRecordEvents;
+
+		m_Stats = stSearchStatsPF();
+		m_vecEvents.clear();
+
+		if (m_bStats)
+			m_StatsTimer.reset();
+	}
+
+	void StatsEnd()
+	{
+		if (m_bStats)
+			m_Stats.dWallTime = m_StatsTimer.elapsed_to_mili();
+	}
+
+	void StatsPush(stCellPF* pCell, size_t szOpen)
+	{
+		if (m_bStats)
+		{
+			m_Stats.nPushes++;
+			m_Stats.nMaxOpenSize = std::max(m_Stats.nMaxOpenSize, (unsigned int)szOpen);
+		}
+
+		if (m_bEvents && pCell)
+			m_vecEvents.push_back({ SearchEventPush, pCell->stIdx });
+	}
+
+	void StatsPop(stCellPF* pCell)
+	{
+		if (m_bStats)
+			m_Stats.nExpanded++;
+
+		if (m_bEvents && pCell)
+			m_vecEvents.push_back({ SearchEventPop, pCell->stIdx });
+	}
+
+	void StatsDecreaseKey(stCellPF* pCell)
+	{
+		if (m_bStats)
+			m_Stats.nDecreaseKeys++;
+
+		if (m_bEvents && pCell)
+			m_vecEvents.push_back({ SearchEventDecreaseKey, pCell->stIdx });
+	}
+
+	void StatsLosCheck()
+	{
+		if (m_bStats)
+			m_Stats.nLosChecks++;
+	}
+
 protected:
 	PathFinderOption* pRefOption{ nullptr };
 
+	bool							m_bStats{ false };
+	bool							m_bEvents{ false };
+	stSearchStatsPF					m_Stats;
+	std::vector<stSearchEventPF>	m_vecEvents;
+	Timer							m_StatsTimer;
+
+	SearchState						m_eSearchState{ SearchIdle };
+	GridPF*							m_pSearchGrid{ nullptr };
+	stCellIdxPF						m_stSearchStart;
+	stCellIdxPF						m_stSearchEnd;
+	std::vector<stCellPF*>			m_vecSearchPath;
+
 	friend class PathFinder;
+	friend class ResumableSearch;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// ResumableSearch class
+
+/*
+* Spread one search over several calls (frames). The strategy keeps its open
+* list and node pool between steps so it must not run another query meanwhile.
+*/
+class ResumableSearch
+{
+public:
+	bool Begin(GridPF* pGridBoard, PathFinding* pStrategy, stCellIdxPF start, stCellIdxPF target,
+			   const PathFinderOption* pOption = nullptr)
+	{
+		m_pStrategy = pStrategy;
+
+		if (!pGridBoard || !pStrategy)
+		{
+			assert(0);
+			return false;
+		}
+
+		if (pOption)
+			m_Option = *pOption;
+
+		m_pStrategy->SetOption(&m_Option);
+
+		return m_pStrategy->SearchBegin(pGridBoard, start, target);
+	}
+
+	/*
+	* Return true while the search still needs steps
+	*/
+	bool Step(size_t nMaxExpansions)
+	{
+		if (!IsRunning())
+			return false;
+
+		m_pStrategy->SearchStep(nMaxExpansions);
+
+		return IsRunning();
+	}
+
+	bool StepFor(unsigned int nMicroseconds)
+	{
+		const size_t nBatch = 64;
+
+		Timer timer;
+
+		while (IsRunning())
+		{
+			m_pStrategy->SearchStep(nBatch);
+
+			if (timer.elapsed_to_mili() * 1000.0 >= nMicroseconds)
+				break;
+		}
+
+		return IsRunning();
+	}
+
+public:
+	SearchState State() const noexcept
+	{
+		return m_pStrategy ? m_pStrategy->GetSearchState() : SearchIdle;
+	}
+
+	bool IsRunning() const noexcept { return State() == SearchRunning; }
+	bool IsFound() const noexcept { return State() == SearchFound; }
+
+	stSearchProgressPF Progress() const
+	{
+		stSearchProgressPF progress;
+		if (m_pStrategy)
+			m_pStrategy->SearchProgress(progress);
+
+		return progress;
+	}
+
+	std::vector<stCellPF*> GetPath() const
+	{
+		if (!m_pStrategy)
+			return std::vector<stCellPF*>();
+
+		return m_pStrategy->SearchPath();
+	}
+
+private:
+	PathFinding*		m_pStrategy{ nullptr };
+	PathFinderOption	m_Option;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +364,11 @@ class PathFinder
 {
 public:	// Set option
 
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
 	void SetOptionAllowCross(bool bAllow) noexcept
 	{
 		m_Option.m_bAllowCross = bAllow;
@@ -60,6 +379,33 @@ public:	// Set option
 		m_Option.m_bDontCrossCorners = bAllow;
 	}
 
+	void SetOptionAgentRadius(float fRadius) noexcept
+	{
+		m_Option.m_fAgentRadius = fRadius;
+	}
+
+	void SetOptionCollectStats(bool bEnable) noexcept
+	{
+		m_Option.m_bCollectStats = bEnable;
+	}
+
+	void SetOptionRecordEvents(bool bEnable) noexcept
+	{
+		m_Option.m_bRecordEvents = bEnable;
+	}
+
+public: // Statistics of the last search
+
+	const stSearchStatsPF* GetStats() const noexcept
+	{
+		return m_pStrategy ? &m_pStrategy->GetStats() : nullptr;
+	}
+
+	const std::vector<stSearchEventPF>* GetEvents() const noexcept
+	{
+		return m_pStrategy ? &m_pStrategy->GetEvents() : nullptr;
+	}
+
 public:
 	void Prepar(GridPF* pGridBoard, PathFinding* pPathFinding) noexcept
 	{
@@ -84,9 +430,44 @@ public:
 		return m_pStrategy->Execute(m_pGridBoard, start, target);
 	}
 
+	/*
+	* Write the path into vecPath, keeping its capacity between queries
+	*/
+	size_t Search(stCellIdxPF start, stCellIdxPF target, std::vector<stCellPF*>& vecPath)
+	{
+		vecPath.clear();
+		if (!m_pStrategy)
+			return 0;
+
+		m_pStrategy->SetOption(&m_Option);
+
+		return m_pStrategy->ExecuteInto(m_pGridBoard, start, target, vecPath);
+	}
+
+	/*
+	* Return the path length, pBuffer is filled only if szCapacity is enough
+	*/
+	size_t Search(stCellIdxPF start, stCellIdxPF target, stCellPF** pBuffer, size_t szCapacity)
+	{
+		if (!m_pStrategy)
+			return 0;
+
+		m_pStrategy->SetOption(&m_Option);
+
+		return m_pStrategy->ExecuteInto(m_pGridBoard, start, target, pBuffer, szCapacity);
+	}
+
+	/*
+	* Start a frame-budgeted search with the current board, strategy and option
+	*/
+	bool Begin(ResumableSearch& search, stCellIdxPF start, stCellIdxPF target)
+	{
+		return search.Begin(m_pGridBoard, m_pStrategy, start, target, &m_Option);
+	}
+
 private:
-	GridPF*				m_pGridBoard;
-	PathFinding*		m_pStrategy;
+	GridPF*				m_pGridBoard{ nullptr };
+	PathFinding*		m_pStrategy{ nullptr };
 
 	PathFinderOption	m_Option;
 };
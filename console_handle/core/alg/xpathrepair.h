@@ -0,0 +1,419 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Local repair of a path after grid edits
+* @file  : xpathrepair.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XPATHREPAIR_H
+#define XPATHREPAIR_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xgridclearance.h"
+#include "xsearchscratch.h"
+
+#define PATHREPAIR_NONE			UINT32_MAX
+#define PATHREPAIR_MARGIN		8		// path cells kept free on each side of a broken segment
+#define PATHREPAIR_WINDOW		16		// cells added around the segment for the local search
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+enum PathRepairResult
+{
+	PathRepairValid,		// path not affected by the edits
+	PathRepairLocal,		// broken segments replaced by local searches
+	PathRepairFull,			// local repair failed, path searched again
+	PathRepairFailed,		// no path anymore, path cleared
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// PathRepair class
+
+/*
+* Checks the moves of a path near the changed cells (a-star rules : blocked
+* cell, corner of a diagonal move, agent radius with a clearance map), groups
+* the broken moves and replaces each group by an a-star between two path
+* cells around it, limited to the bounding box of that part of the path plus
+* a window margin. A group failing in its window is tried once in a window
+* twice as large, then the whole path is searched again (fallback finder or
+* an internal a-star). The repaired part is the best detour inside the
+* window only, the spliced path is not optimal over the whole board.
+*/
+class PathRepair
+{
+	typedef struct _stRepairNode
+	{
+		float		fCost{ FLT_MAX };
+		uint32_t	nPrev{ PATHREPAIR_NONE };
+		uint32_t	nGeneration{ 0 };
+		bool		bClosed{ false };
+	} stRepairNodePF;
+
+	typedef struct _stRepairOpen
+	{
+		float		fScore{ 0.f };
+		float		fCost{ 0.f };
+		uint32_t	nNode{ 0 };
+
+		bool operator<(const _stRepairOpen& other) const noexcept
+		{
+			if (fScore != other.fScore)
+				return fScore > other.fScore;
+
+			return fCost < other.fCost;
+		}
+	} stRepairOpenPF;
+
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	void SetClearance(const GridPFClearance* pClearance) noexcept
+	{
+		m_pClearance = pClearance;
+	}
+
+	/* Margins : path cells kept on each side of a broken segment, cells added around it */
+	void SetMargin(const int nPathMargin, const int nWindowMargin) noexcept
+	{
+		m_nPathMargin = std::max(nPathMargin, 0);
+		m_nWindowMargin = std::max(nWindowMargin, 0);
+	}
+
+	/*******************************************************************************
+	*! @brief  : Fix vecPath after the cells of vecChanged were edited
+	*! @param  : [in] vecChanged : edited cells, empty = check the whole path
+	*! @param  : [in] pFallback  : finder of the full search (prepared on the same
+	*!                             board), nullptr = internal a-star
+	*! @return : PathRepairResult, vecPath is cleared on PathRepairFailed
+	*******************************************************************************/
+	PathRepairResult Repair(GridPF* pGridBoard, std::vector<stCellPF*>& vecPath,
+							const std::vector<stCellIdxPF>& vecChanged, PathFinder* pFallback = nullptr)
+	{
+		m_pGridBoard = pGridBoard;
+		m_bClearance = m_Option.m_fAgentRadius > 0.f && m_pClearance && m_pClearance->Grid() == pGridBoard;
+
+		if (!pGridBoard || vecPath.empty())
+			return PathRepairFailed;
+
+		if (!FindBroken(vecPath, vecChanged))
+			return PathRepairValid;
+
+		// groups from the end : splicing does not move the earlier indices
+		const int nPath = int(vecPath.size());
+		int nGroupEnd = int(m_vecBroken.size()) - 1;
+
+		while (nGroupEnd >= 0)
+		{
+			int nGroupBegin = nGroupEnd;
+			while (nGroupBegin > 0 && int(m_vecBroken[nGroupBegin] - m_vecBroken[nGroupBegin - 1]) <= 2 * m_nPathMargin + 1)
+				nGroupBegin--;
+
+			// move i : vecPath[i] -> vecPath[i + 1]
+			int nFrom = std::max(int(m_vecBroken[nGroupBegin]) - m_nPathMargin, 0);
+			int nTo = std::min(int(m_vecBroken[nGroupEnd]) + 1 + m_nPathMargin, nPath - 1);
+
+			if (!RepairSegment(vecPath, nFrom, nTo))
+				return FullSearch(vecPath, pFallback);
+
+			nGroupEnd = nGroupBegin - 1;
+		}
+
+		return PathRepairLocal;
+	}
+
+	/* Scratch bytes held by this instance */
+	size_t MemorySize() const noexcept
+	{
+		return m_Nodes.MemorySize() + m_Open.MemorySize() +
+			   m_vecBroken.capacity() * sizeof(uint32_t) + m_vecDetour.capacity() * sizeof(stCellPF*);
+	}
+
+protected:
+	/* Broken moves near the changed cells into m_vecBroken (increasing), true if any */
+	bool FindBroken(const std::vector<stCellPF*>& vecPath, const std::vector<stCellIdxPF>& vecChanged)
+	{
+		m_vecBroken.clear();
+
+		// a move reads its cells and the corner ones : box of the edits grown by one (+ agent radius)
+		int nGrow = 1 + (m_bClearance ? int(std::ceil(m_Option.m_fAgentRadius)) : 0);
+		int nMinX = INT32_MIN, nMinY = INT32_MIN, nMaxX = INT32_MAX, nMaxY = INT32_MAX;
+
+		if (!vecChanged.empty())
+		{
+			nMinX = nMinY = INT32_MAX;
+			nMaxX = nMaxY = INT32_MIN;
+
+			for (const stCellIdxPF& idx : vecChanged)
+			{
+				nMinX = std::min(nMinX, idx.nX - nGrow);
+				nMinY = std::min(nMinY, idx.nY - nGrow);
+				nMaxX = std::max(nMaxX, idx.nX + nGrow);
+				nMaxY = std::max(nMaxY, idx.nY + nGrow);
+			}
+		}
+
+		auto bInBox = [&](const stCellIdxPF& idx)
+		{
+			return idx.nX >= nMinX && idx.nX <= nMaxX && idx.nY >= nMinY && idx.nY <= nMaxY;
+		};
+
+		if (vecPath.size() == 1)
+		{
+			const stCellIdxPF& idx = vecPath[0]->stIdx;
+			if (bInBox(idx) && !IsFree(idx.nX, idx.nY))
+				m_vecBroken.push_back(0);
+		}
+
+		for (size_t i = 0; i + 1 < vecPath.size(); i++)
+		{
+			const stCellIdxPF& a = vecPath[i]->stIdx;
+			const stCellIdxPF& b = vecPath[i + 1]->stIdx;
+
+			if (!bInBox(a) && !bInBox(b))
+				continue;
+
+			if (!IsFree(a.nX, a.nY) || !CanMove(a.nX, a.nY, b.nX - a.nX, b.nY - a.nY))
+				m_vecBroken.push_back(uint32_t(i));
+		}
+
+		return !m_vecBroken.empty();
+	}
+
+	/* Replace vecPath[nFrom .. nTo] by a local a-star, one retry in a larger window */
+	bool RepairSegment(std::vector<stCellPF*>& vecPath, const int nFrom, const int nTo)
+	{
+		const stCellIdxPF start = vecPath[nFrom]->stIdx;
+		const stCellIdxPF target = vecPath[nTo]->stIdx;
+
+		if (!IsFree(start.nX, start.nY) || !IsFree(target.nX, target.nY))
+			return false;
+
+		int nMinX = INT32_MAX, nMinY = INT32_MAX, nMaxX = INT32_MIN, nMaxY = INT32_MIN;
+		for (int i = nFrom; i <= nTo; i++)
+		{
+			nMinX = std::min(nMinX, vecPath[i]->stIdx.nX);
+			nMinY = std::min(nMinY, vecPath[i]->stIdx.nY);
+			nMaxX = std::max(nMaxX, vecPath[i]->stIdx.nX);
+			nMaxY = std::max(nMaxY, vecPath[i]->stIdx.nY);
+		}
+
+		for (int nTry = 1; nTry <= 2; nTry++)
+		{
+			int nMargin = std::max(m_nWindowMargin, 1) * nTry;
+			if (!PrepareWindow(nMinX - nMargin, nMinY - nMargin, nMaxX + nMargin, nMaxY + nMargin))
+				continue;
+
+			if (Search(start, target))
+			{
+				vecPath.erase(vecPath.begin() + nFrom, vecPath.begin() + nTo + 1);
+				vecPath.insert(vecPath.begin() + nFrom, m_vecDetour.begin(), m_vecDetour.end());
+				return true;
+			}
+
+			// window already the whole board
+			if (m_nWindowCols == m_pGridBoard->Cols() && m_nWindowRows == m_pGridBoard->Rows())
+				break;
+		}
+
+		return false;
+	}
+
+	PathRepairResult FullSearch(std::vector<stCellPF*>& vecPath, PathFinder* pFallback)
+	{
+		const stCellIdxPF start = vecPath.front()->stIdx;
+		const stCellIdxPF target = vecPath.back()->stIdx;
+
+		if (!IsFree(start.nX, start.nY) || !IsFree(target.nX, target.nY))
+		{
+			vecPath.clear();
+			return PathRepairFailed;
+		}
+
+		if (!pFallback)
+		{
+			m_Fallback.SetOption(m_Option);
+			m_Fallback.Prepar(m_pGridBoard, &m_AStar);
+			pFallback = &m_Fallback;
+		}
+
+		pFallback->Search(start, target, vecPath);
+
+		return vecPath.empty() ? PathRepairFailed : PathRepairFull;
+	}
+
+	/* Clip the window to the board, reset the scratch */
+	bool PrepareWindow(int nMinX, int nMinY, int nMaxX, int nMaxY)
+	{
+		nMinX = std::max(nMinX, 0);
+		nMinY = std::max(nMinY, 0);
+		nMaxX = std::min(nMaxX, m_pGridBoard->Cols() - 1);
+		nMaxY = std::min(nMaxY, m_pGridBoard->Rows() - 1);
+
+		if (nMinX > nMaxX || nMinY > nMaxY)
+			return false;
+
+		m_nOriginX = nMinX;
+		m_nOriginY = nMinY;
+		m_nWindowCols = nMaxX - nMinX + 1;
+		m_nWindowRows = nMaxY - nMinY + 1;
+
+		m_Nodes.Begin(size_t(m_nWindowCols) * m_nWindowRows);
+
+		return true;
+	}
+
+	/* A-star inside the window, path into m_vecDetour (start and target included) */
+	bool Search(const stCellIdxPF start, const stCellIdxPF target)
+	{
+		m_vecDetour.clear();
+		m_Open.Clear();
+
+		const int nDirs = m_Option.m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		const uint32_t nTarget = NodeIndex(target.nX, target.nY);
+
+		m_Nodes.Get(NodeIndex(start.nX, start.nY)).fCost = 0.f;
+		m_Open.Push({ Heuristic(start, target), 0.f, NodeIndex(start.nX, start.nY) });
+
+		while (!m_Open.Empty())
+		{
+			stRepairOpenPF stOpen = m_Open.Pop();
+
+			stRepairNodePF& node = m_Nodes[stOpen.nNode];
+			if (node.bClosed || stOpen.fCost > node.fCost)
+				continue;
+
+			node.bClosed = true;
+
+			if (stOpen.nNode == nTarget)
+			{
+				for (uint32_t n = nTarget; n != PATHREPAIR_NONE; n = m_Nodes[n].nPrev)
+					m_vecDetour.push_back(m_pGridBoard->Get(NodeCell(n)));
+
+				std::reverse(m_vecDetour.begin(), m_vecDetour.end());
+				return true;
+			}
+
+			const stCellIdxPF idx = NodeCell(stOpen.nNode);
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				int dx = arDir[d][0], dy = arDir[d][1];
+				int nx = idx.nX + dx, ny = idx.nY + dy;
+
+				if (nx < m_nOriginX || ny < m_nOriginY || nx >= m_nOriginX + m_nWindowCols || ny >= m_nOriginY + m_nWindowRows)
+					continue;
+
+				if (!CanMove(idx.nX, idx.nY, dx, dy))
+					continue;
+
+				float fCost = stOpen.fCost + (d < 4 ? 1.f : 1.412f);
+				uint32_t nNext = NodeIndex(nx, ny);
+
+				stRepairNodePF& next = m_Nodes.Get(nNext);
+				if (next.bClosed || next.fCost <= fCost)
+					continue;
+
+				next.fCost = fCost;
+				next.nPrev = stOpen.nNode;
+
+				m_Open.Push({ fCost + Heuristic({ nx, ny }, target), fCost, nNext });
+			}
+		}
+
+		return false;
+	}
+
+	uint32_t NodeIndex(const int x, const int y) const noexcept
+	{
+		return uint32_t(x - m_nOriginX) + uint32_t(y - m_nOriginY) * uint32_t(m_nWindowCols);
+	}
+
+	stCellIdxPF NodeCell(const uint32_t nNode) const noexcept
+	{
+		return { m_nOriginX + int(nNode % m_nWindowCols), m_nOriginY + int(nNode / m_nWindowCols) };
+	}
+
+	float Heuristic(const stCellIdxPF a, const stCellIdxPF b) const noexcept
+	{
+		int dx = std::abs(a.nX - b.nX), dy = std::abs(a.nY - b.nY);
+
+		if (!m_Option.m_bAllowCross)
+			return float(dx + dy);
+
+		return float(std::abs(dx - dy)) + 1.412f * float(std::min(dx, dy));
+	}
+
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_pGridBoard->Cols() || y >= m_pGridBoard->Rows())
+			return false;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		if (!pCell || pCell->stData.fWeight > 0)
+			return false;
+
+		return !m_bClearance || m_pClearance->IsClear(x, y, m_Option.m_fAgentRadius);
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0))
+			return false;
+
+		if (!IsFree(x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		if (!m_Option.m_bAllowCross)
+			return false;
+
+		bool bSide1 = IsFree(x + dx, y);
+		bool bSide2 = IsFree(x, y + dy);
+
+		return m_Option.m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	const GridPFClearance*		m_pClearance{ nullptr };
+	GridPF*						m_pGridBoard{ nullptr };
+	bool						m_bClearance{ false };
+	int							m_nPathMargin{ PATHREPAIR_MARGIN };
+	int							m_nWindowMargin{ PATHREPAIR_WINDOW };
+
+	// full search when the local one fails
+	AStar						m_AStar;
+	PathFinder					m_Fallback;
+
+	// window scratch
+	int							m_nOriginX{ 0 };
+	int							m_nOriginY{ 0 };
+	int							m_nWindowCols{ 0 };
+	int							m_nWindowRows{ 0 };
+	SearchRecords<stRepairNodePF>	m_Nodes;
+	SearchOpenList<stRepairOpenPF>	m_Open;
+
+	std::vector<uint32_t>		m_vecBroken;
+	std::vector<stCellPF*>		m_vecDetour;
+};
+
+#endif // !XPATHREPAIR_H
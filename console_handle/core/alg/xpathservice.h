@@ -0,0 +1,383 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Asynchronous path request service
+* @file  : xpathservice.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XPATHSERVICE_H
+#define XPATHSERVICE_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_set>
+#include "xpathfinder.h"
+#include "xgridsnapshot.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+enum PathRequestStatus
+{
+	PathRequestDone,		// path found
+	PathRequestNotFound,	// search finished without path
+	PathRequestCancelled,	// cancelled by user or service stopped
+	PathRequestStale,		// grid changed since the request was submitted
+};
+
+typedef struct _stPathRequest
+{
+	stCellIdxPF stStart;
+	stCellIdxPF stTarget;
+	int			nPriority{ 0 };		// higher value is served first
+} stPathRequestPF;
+
+typedef struct _stPathResult
+{
+	unsigned int			nRequestId{ 0 };
+	unsigned int			nGridVersion{ 0 };
+	PathRequestStatus		eStatus{ PathRequestCancelled };
+	std::vector<stCellPF*>	vecPath;
+} stPathResultPF;
+
+typedef struct _stPathTicket
+{
+	unsigned int					nRequestId{ 0 };
+	std::future<stPathResultPF>		Result;
+} stPathTicketPF;
+
+typedef std::function<void(const stPathResultPF&)> pFunPathRequestDone;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// PathRequestService class
+
+/*
+* Requests run on background workers against a shared GridPF. Each worker owns
+* its strategy instance. The grid must not be edited while a search reads it ;
+* edits done between searches make the pending results stale instead.
+* Started on GridPFSnapshots the grid can be edited at any time : a worker
+* pins the latest published snapshot when it picks a request, syncs its own
+* replica grid to it and searches the replica (result version = snapshot
+* version, never stale). The path cells then belong to the worker replica :
+* use their stIdx, their data may change on the next request of the worker.
+*/
+class PathRequestService
+{
+protected:
+	typedef std::function<PathFinding*()> FunCreateStrategy;
+
+	typedef struct _stPathJob
+	{
+		unsigned int				nId{ 0 };
+		unsigned int				nVersion{ 0 };
+		stPathRequestPF				stRequest;
+		std::promise<stPathResultPF> Promise;
+		pFunPathRequestDone			funDone;
+	} stPathJob;
+
+	typedef std::shared_ptr<stPathJob> PathJobPtr;
+
+	typedef struct _stPathJobCompare
+	{
+		bool operator()(const PathJobPtr& pJ1, const PathJobPtr& pJ2) const
+		{
+			if (pJ1->stRequest.nPriority == pJ2->stRequest.nPriority)
+				return pJ1->nId > pJ2->nId;
+
+			return pJ1->stRequest.nPriority < pJ2->stRequest.nPriority;
+		}
+	} stPathJobCompare;
+
+	typedef std::priority_queue<PathJobPtr, std::vector<PathJobPtr>, stPathJobCompare> PathJobQueue;
+
+public:
+	~PathRequestService()
+	{
+		Stop();
+	}
+
+public:
+	/*
+	* fnCreate is called once per worker, the service owns the created strategies
+	*/
+	bool Start(GridPF* pGridBoard, FunCreateStrategy fnCreate, unsigned int nWorkers = 0)
+	{
+		if (!pGridBoard || !fnCreate || !m_vecWorkers.empty())
+		{
+			assert(0);
+			return false;
+		}
+
+		m_pGridBoard = pGridBoard;
+		m_pSnapshots = nullptr;
+
+		return StartWorkers(fnCreate, nWorkers);
+	}
+
+	/*
+	* Search the published snapshots, pSnapshots must be attached to the grid
+	*/
+	bool Start(GridPFSnapshots* pSnapshots, FunCreateStrategy fnCreate, unsigned int nWorkers = 0)
+	{
+		if (!pSnapshots || !pSnapshots->Acquire() || !fnCreate || !m_vecWorkers.empty())
+		{
+			assert(0);
+			return false;
+		}
+
+		m_pGridBoard = nullptr;
+		m_pSnapshots = pSnapshots;
+
+		return StartWorkers(fnCreate, nWorkers);
+	}
+
+	void Stop()
+	{
+		{
+			std::unique_lock<std::mutex> lck(m_mutex);
+			m_bStop = true;
+		}
+		m_cvJob.notify_all();
+
+		for (auto& worker : m_vecWorkers)
+		{
+			if (worker.joinable())
+				worker.join();
+		}
+
+		m_vecWorkers.clear();
+		m_vecStrategies.clear();
+
+		// Pending requests never run
+		while (!m_JobQueue.empty())
+		{
+			Complete(m_JobQueue.top(), PathRequestCancelled, std::vector<stCellPF*>());
+			m_JobQueue.pop();
+		}
+
+		m_LiveRequests.clear();
+		m_CancelRequests.clear();
+		m_nCancelUpTo = m_nRequestId;
+	}
+
+	void SetOption(const PathFinderOption& option)
+	{
+		std::unique_lock<std::mutex> lck(m_mutex);
+		m_Option = option;
+	}
+
+public:
+	stPathTicketPF Submit(const stPathRequestPF& request, pFunPathRequestDone funDone = nullptr)
+	{
+		PathJobPtr pJob = std::make_shared<stPathJob>();
+		pJob->stRequest = request;
+		pJob->funDone = funDone;
+		pJob->nVersion = CurrentVersion();
+
+		stPathTicketPF ticket;
+		ticket.Result = pJob->Promise.get_future();
+
+		{
+			std::unique_lock<std::mutex> lck(m_mutex);
+			pJob->nId = ++m_nRequestId;
+			ticket.nRequestId = pJob->nId;
+
+			if (m_bStop || m_vecWorkers.empty())
+			{
+				lck.unlock();
+				Complete(pJob, PathRequestCancelled, std::vector<stCellPF*>());
+				return ticket;
+			}
+
+			m_JobQueue.push(pJob);
+			m_LiveRequests.insert(pJob->nId);
+		}
+		m_cvJob.notify_one();
+
+		return ticket;
+	}
+
+	/*
+	* A cancelled request is dropped when a worker picks it up, or its result is
+	* discarded if the search is already running. Ids already completed are ignored
+	*/
+	void Cancel(unsigned int nRequestId)
+	{
+		std::unique_lock<std::mutex> lck(m_mutex);
+		if (m_LiveRequests.count(nRequestId))
+			m_CancelRequests.insert(nRequestId);
+	}
+
+	void CancelAll()
+	{
+		std::unique_lock<std::mutex> lck(m_mutex);
+		m_nCancelUpTo = m_nRequestId;
+		m_CancelRequests.clear();
+	}
+
+	size_t Pending()
+	{
+		std::unique_lock<std::mutex> lck(m_mutex);
+		return m_JobQueue.size();
+	}
+
+protected:
+	bool StartWorkers(FunCreateStrategy fnCreate, unsigned int nWorkers)
+	{
+		if (nWorkers == 0)
+			nWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		m_bStop = false;
+
+		for (unsigned int i = 0; i < nWorkers; i++)
+		{
+			std::unique_ptr<PathFinding> pStrategy(fnCreate());
+			if (!pStrategy)
+				continue;
+
+			m_vecStrategies.push_back(std::move(pStrategy));
+		}
+
+		for (size_t i = 0; i < m_vecStrategies.size(); i++)
+		{
+			m_vecWorkers.emplace_back(&PathRequestService::WorkerLoop, this, m_vecStrategies[i].get());
+		}
+
+		return !m_vecWorkers.empty();
+	}
+
+	bool IsCancelled(unsigned int nRequestId, bool bErase)
+	{
+		std::unique_lock<std::mutex> lck(m_mutex);
+		if (nRequestId <= m_nCancelUpTo)
+			return true;
+
+		auto itFond = m_CancelRequests.find(nRequestId);
+		if (itFond == m_CancelRequests.end())
+			return false;
+
+		if (bErase)
+			m_CancelRequests.erase(itFond);
+
+		return true;
+	}
+
+	void Complete(const PathJobPtr& pJob, PathRequestStatus eStatus, std::vector<stCellPF*>&& vecPath)
+	{
+		{
+			std::unique_lock<std::mutex> lck(m_mutex);
+			m_LiveRequests.erase(pJob->nId);
+			m_CancelRequests.erase(pJob->nId);
+		}
+
+		stPathResultPF result;
+		result.nRequestId = pJob->nId;
+		result.nGridVersion = pJob->nVersion;
+		result.eStatus = eStatus;
+		result.vecPath = std::move(vecPath);
+
+		if (pJob->funDone)
+			pJob->funDone(result);
+
+		pJob->Promise.set_value(std::move(result));
+	}
+
+	unsigned int CurrentVersion() const
+	{
+		if (m_pSnapshots)
+		{
+			GridPFSnapshotPtr pSnapshot = m_pSnapshots->Acquire();
+			return pSnapshot ? pSnapshot->Version() : 0;
+		}
+
+		return m_pGridBoard ? m_pGridBoard->Version() : 0;
+	}
+
+	void WorkerLoop(PathFinding* pStrategy)
+	{
+		GridPFReplica replica;
+
+		PathFinder finder;
+		finder.Prepar(m_pSnapshots ? replica.Grid() : m_pGridBoard, pStrategy);
+
+		while (true)
+		{
+			PathJobPtr pJob;
+			{
+				std::unique_lock<std::mutex> lck(m_mutex);
+				m_cvJob.wait(lck, [this]() { return m_bStop || !m_JobQueue.empty(); });
+
+				if (m_bStop)
+					return;
+
+				pJob = m_JobQueue.top();
+				m_JobQueue.pop();
+
+				finder.SetOption(m_Option);
+			}
+
+			if (IsCancelled(pJob->nId, true))
+			{
+				Complete(pJob, PathRequestCancelled, std::vector<stCellPF*>());
+				continue;
+			}
+
+			if (m_pSnapshots)
+			{
+				// pin the latest snapshot, edits published meanwhile go to the next requests
+				GridPFSnapshotPtr pSnapshot = m_pSnapshots->Acquire();
+				replica.Sync(pSnapshot);
+				pJob->nVersion = pSnapshot->Version();
+			}
+			else if (pJob->nVersion != m_pGridBoard->Version())
+			{
+				Complete(pJob, PathRequestStale, std::vector<stCellPF*>());
+				continue;
+			}
+
+			std::vector<stCellPF*> vecPath = finder.Search(pJob->stRequest.stStart, pJob->stRequest.stTarget);
+
+			if (IsCancelled(pJob->nId, true))
+			{
+				Complete(pJob, PathRequestCancelled, std::vector<stCellPF*>());
+			}
+			else if (!m_pSnapshots && pJob->nVersion != m_pGridBoard->Version())
+			{
+				Complete(pJob, PathRequestStale, std::vector<stCellPF*>());
+			}
+			else
+			{
+				Complete(pJob, vecPath.empty() ? PathRequestNotFound : PathRequestDone, std::move(vecPath));
+			}
+		}
+	}
+
+protected:
+	GridPF*										m_pGridBoard{ nullptr };
+	GridPFSnapshots*							m_pSnapshots{ nullptr };
+	PathFinderOption							m_Option;
+
+	std::vector<std::unique_ptr<PathFinding>>	m_vecStrategies;
+	std::vector<std::thread>					m_vecWorkers;
+
+	std::mutex									m_mutex;
+	std::condition_variable						m_cvJob;
+	PathJobQueue								m_JobQueue;
+	std::unordered_set<unsigned int>			m_LiveRequests;		// queued or running
+	std::unordered_set<unsigned int>			m_CancelRequests;	// subset of the live ones
+	unsigned int								m_nRequestId{ 0 };
+	unsigned int								m_nCancelUpTo{ 0 };	// all ids <= are cancelled
+	bool										m_bStop{ false };
+};
+
+#endif // XPATHSERVICE_H
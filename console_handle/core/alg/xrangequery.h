@@ -0,0 +1,276 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Cost-bounded range query (all cells reachable within a budget)
+* @file  : xrangequery.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XRANGEQUERY_H
+#define XRANGEQUERY_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xgridclearance.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define RANGEQUERY_EPSILON		1e-4f
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stRangeCell
+{
+	stCellPF*	pCell{ nullptr };
+	float		fCost{ 0.f };
+} stRangeCellPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// RangeQuery class
+
+/*
+* Dijkstra from the start stopped at the cost budget, moves and costs of
+* a-star (1 / 1.412, cross, dont cross corners, agent radius with a
+* clearance map). Every move costs at least 1 so the reached cells lie in
+* the square of half size floor(budget) around the start : the scratch is
+* that window only, reused between queries (no allocation once warmed up).
+* One query at a time per instance, RangeQueryBatch runs many on threads.
+*/
+class RangeQuery
+{
+	typedef struct _stRangeNode
+	{
+		float		fCost{ -1.f };		// < 0 : not reached
+		uint32_t	nGeneration{ 0 };
+		bool		bClosed{ false };
+	} stRangeNodePF;
+
+	typedef struct _stRangeOpen
+	{
+		float		fCost{ 0.f };
+		int			nX{ 0 };
+		int			nY{ 0 };
+
+		bool operator<(const _stRangeOpen& other) const noexcept
+		{
+			return fCost > other.fCost;
+		}
+	} stRangeOpenPF;
+
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	/* Clearance map used when the agent radius option is set */
+	void SetClearance(const GridPFClearance* pClearance) noexcept
+	{
+		m_pClearance = pClearance;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Cells reachable from start with a path cost <= fMaxCost
+	*! @param  : [out] vecOut : cleared, cells by increasing cost (start first)
+	*! @return : number of cells, 0 if the start is blocked
+	*******************************************************************************/
+	size_t Query(GridPF* pGridBoard, stCellIdxPF start, const float fMaxCost, std::vector<stRangeCellPF>& vecOut)
+	{
+		vecOut.clear();
+
+		m_pGridBoard = pGridBoard;
+		m_bClearance = m_Option.m_fAgentRadius > 0.f && m_pClearance && m_pClearance->Grid() == pGridBoard;
+
+		if (!pGridBoard || fMaxCost < 0.f || !IsFree(start.nX, start.nY))
+			return 0;
+
+		PrepareWindow(start, fMaxCost);
+
+		const int nDirs = m_Option.m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		const float fBudget = fMaxCost + RANGEQUERY_EPSILON;
+
+		m_Open.Clear();
+
+		Node(start.nX, start.nY).fCost = 0.f;
+		m_Open.Push({ 0.f, start.nX, start.nY });
+
+		while (!m_Open.Empty())
+		{
+			stRangeOpenPF stOpen = m_Open.Pop();
+
+			stRangeNodePF& node = Node(stOpen.nX, stOpen.nY);
+			if (node.bClosed || stOpen.fCost > node.fCost)
+				continue;
+
+			node.bClosed = true;
+			vecOut.push_back({ pGridBoard->Get(stOpen.nX, stOpen.nY), stOpen.fCost });
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				float fCost = stOpen.fCost + (d < 4 ? 1.f : 1.412f);
+				if (fCost > fBudget)
+					continue;
+
+				int dx = arDir[d][0], dy = arDir[d][1];
+				if (!CanMove(stOpen.nX, stOpen.nY, dx, dy))
+					continue;
+
+				stRangeNodePF& next = Node(stOpen.nX + dx, stOpen.nY + dy);
+				if (next.bClosed || (next.fCost >= 0.f && next.fCost <= fCost))
+					continue;
+
+				next.fCost = fCost;
+
+				m_Open.Push({ fCost, stOpen.nX + dx, stOpen.nY + dy });
+			}
+		}
+
+		return vecOut.size();
+	}
+
+	/* Scratch bytes held by this instance */
+	size_t MemorySize() const noexcept
+	{
+		return m_Nodes.MemorySize() + m_Open.MemorySize();
+	}
+
+protected:
+	/* Window = board part within floor(fMaxCost) of the start */
+	void PrepareWindow(stCellIdxPF start, const float fMaxCost)
+	{
+		int nRadius = int(std::min(std::floor(fMaxCost + RANGEQUERY_EPSILON),
+								   float(std::max(m_pGridBoard->Cols(), m_pGridBoard->Rows()))));
+
+		m_nOriginX = std::max(start.nX - nRadius, 0);
+		m_nOriginY = std::max(start.nY - nRadius, 0);
+		m_nWindowCols = std::min(start.nX + nRadius, m_pGridBoard->Cols() - 1) - m_nOriginX + 1;
+		int nWindowRows = std::min(start.nY + nRadius, m_pGridBoard->Rows() - 1) - m_nOriginY + 1;
+
+		m_Nodes.Begin(size_t(m_nWindowCols) * nWindowRows);
+	}
+
+	/* Record of a window cell for the current query */
+	stRangeNodePF& Node(const int x, const int y) noexcept
+	{
+		return m_Nodes.Get(size_t(x - m_nOriginX) + size_t(y - m_nOriginY) * m_nWindowCols);
+	}
+
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_pGridBoard->Cols() || y >= m_pGridBoard->Rows())
+			return false;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		if (!pCell || pCell->stData.fWeight > 0)
+			return false;
+
+		return !m_bClearance || m_pClearance->IsClear(x, y, m_Option.m_fAgentRadius);
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		bool bSide1 = IsFree(x + dx, y);
+		bool bSide2 = IsFree(x, y + dy);
+
+		return m_Option.m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	const GridPFClearance*		m_pClearance{ nullptr };
+	GridPF*						m_pGridBoard{ nullptr };
+	bool						m_bClearance{ false };
+
+	// window scratch
+	int							m_nOriginX{ 0 };
+	int							m_nOriginY{ 0 };
+	int							m_nWindowCols{ 0 };
+	SearchRecords<stRangeNodePF>	m_Nodes;
+	SearchOpenList<stRangeOpenPF>	m_Open;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// RangeQueryBatch class
+
+/*
+* Range queries of many units split over threads, one RangeQuery scratch
+* per thread kept between batches. Output buffers are reused as well.
+*/
+class RangeQueryBatch
+{
+public:
+	void SetOption(const PathFinderOption& option) noexcept
+	{
+		m_Option = option;
+	}
+
+	void SetClearance(const GridPFClearance* pClearance) noexcept
+	{
+		m_pClearance = pClearance;
+	}
+
+	/*******************************************************************************
+	*! @brief  : vecOut[i] = range of vecStart[i]
+	*! @param  : [in] vecMaxCost : one budget per unit, or a single one for all
+	*! @param  : [in] nThreads   : 0 = all hardware threads
+	*******************************************************************************/
+	void Query(GridPF* pGridBoard, const std::vector<stCellIdxPF>& vecStart, const std::vector<float>& vecMaxCost,
+			   std::vector<std::vector<stRangeCellPF>>& vecOut, const unsigned int nThreads = 0)
+	{
+		vecOut.resize(vecStart.size());
+
+		if (vecStart.empty() || vecMaxCost.empty())
+			return;
+
+		unsigned int nWorkers = util::thread_count(nThreads);
+		if (m_vecWorkers.size() < nWorkers)
+			m_vecWorkers.resize(nWorkers);
+
+		for (auto& worker : m_vecWorkers)
+		{
+			worker.SetOption(m_Option);
+			worker.SetClearance(m_pClearance);
+		}
+
+		util::parallel_for(0, vecStart.size(), [&](size_t nBegin, size_t nEnd, unsigned int t)
+		{
+			RangeQuery& worker = m_vecWorkers[t];
+			for (size_t i = nBegin; i < nEnd; i++)
+			{
+				float fMaxCost = vecMaxCost.size() == vecStart.size() ? vecMaxCost[i] : vecMaxCost[0];
+				worker.Query(pGridBoard, vecStart[i], fMaxCost, vecOut[i]);
+			}
+		}, nWorkers);
+	}
+
+	void Query(GridPF* pGridBoard, const std::vector<stCellIdxPF>& vecStart, const float fMaxCost,
+			   std::vector<std::vector<stRangeCellPF>>& vecOut, const unsigned int nThreads = 0)
+	{
+		Query(pGridBoard, vecStart, std::vector<float>(1, fMaxCost), vecOut, nThreads);
+	}
+
+protected:
+	PathFinderOption			m_Option;
+	const GridPFClearance*		m_pClearance{ nullptr };
+	std::vector<RangeQuery>		m_vecWorkers;
+};
+
+#endif // !XRANGEQUERY_H
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Search scratch shared by the graph searches (node records, open list)
+* @file  : xsearchscratch.h
+* @create: Oct 19, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XSEARCHSCRATCH_H
+#define XSEARCHSCRATCH_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SearchRecords class
+
+/*
+* One record per node, kept between the searches and reset lazily : Begin
+* starts a new generation, a record stamped with an older one reads as a
+* default _Node. _Node needs a 32 bits nGeneration member (0 : never used).
+* A full reset only happens when the generation wraps around.
+*/
+template<typename _Node>
+class SearchRecords
+{
+public:
+	/*******************************************************************************
+	*! @brief  : New search over nodes [0, szCount), every record becomes unused
+	*******************************************************************************/
+	void Begin(const size_t szCount)
+	{
+		if (m_vecRecords.size() < szCount)
+		{
+			m_vecRecords.assign(szCount, _Node());
+			m_nGeneration = 0;
+		}
+
+		if (++m_nGeneration == 0)
+		{
+			std::fill(m_vecRecords.begin(), m_vecRecords.end(), _Node());
+			m_nGeneration = 1;
+		}
+	}
+
+	/* Used by the current search */
+	bool IsCurrent(const size_t nNode) const noexcept
+	{
+		return m_vecRecords[nNode].nGeneration == m_nGeneration;
+	}
+
+	/* Record of the current search, a default one when unused */
+	_Node& Get(const size_t nNode) noexcept
+	{
+		_Node& rec = m_vecRecords[nNode];
+		if (rec.nGeneration != m_nGeneration)
+		{
+			rec = _Node();
+			rec.nGeneration = m_nGeneration;
+		}
+
+		return rec;
+	}
+
+	/* Record as stored (walking back the current search) */
+	_Node& operator[](const size_t nNode) noexcept { return m_vecRecords[nNode]; }
+	const _Node& operator[](const size_t nNode) const noexcept { return m_vecRecords[nNode]; }
+
+	uint32_t Generation() const noexcept { return m_nGeneration; }
+	size_t Size() const noexcept { return m_vecRecords.size(); }
+
+	void Clear()
+	{
+		std::vector<_Node>().swap(m_vecRecords);
+		m_nGeneration = 0;
+	}
+
+	size_t MemorySize() const noexcept
+	{
+		return m_vecRecords.capacity() * sizeof(_Node);
+	}
+
+protected:
+	std::vector<_Node>				m_vecRecords;
+	uint32_t						m_nGeneration{ 0 };
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SearchOpenList class
+
+/*
+* Binary heap over std::vector (std::push_heap / pop_heap). Top is the
+* greatest item for _Open::operator<, which the open items define reversed
+* (a > b on the score) to pop the lowest score first. Entries are not
+* updated in place : a better cost pushes a new one, stale ones are skipped
+* by the caller when popped.
+*/
+template<typename _Open>
+class SearchOpenList
+{
+public:
+	void Clear() noexcept { m_vecOpen.clear(); }
+	bool Empty() const noexcept { return m_vecOpen.empty(); }
+	size_t Size() const noexcept { return m_vecOpen.size(); }
+	const _Open& Top() const noexcept { return m_vecOpen.front(); }
+
+	void Push(const _Open& open)
+	{
+		m_vecOpen.push_back(open);
+		std::push_heap(m_vecOpen.begin(), m_vecOpen.end());
+	}
+
+	_Open Pop()
+	{
+		std::pop_heap(m_vecOpen.begin(), m_vecOpen.end());
+		_Open open = m_vecOpen.back();
+		m_vecOpen.pop_back();
+
+		return open;
+	}
+
+	size_t MemorySize() const noexcept
+	{
+		return m_vecOpen.capacity() * sizeof(_Open);
+	}
+
+protected:
+	std::vector<_Open>				m_vecOpen;
+};
+
+#endif // !XSEARCHSCRATCH_H
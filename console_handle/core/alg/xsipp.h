@@ -0,0 +1,564 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Safe interval path planning (known moving obstacles)
+* @file  : xsipp.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XSIPP_H
+#define XSIPP_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+
+#define SIPP_NONE		0xFFFFFFFFu
+#define SIPP_FOREVER	FLT_MAX
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stTimeInterval
+{
+	float		fBegin{ 0.f };
+	float		fEnd{ SIPP_FOREVER };
+} stTimeIntervalPF;
+
+typedef struct _stTimedIdx
+{
+	stCellIdxPF	stIdx;
+	float		fTime{ 0.f };
+} stTimedIdxPF;
+
+typedef struct _stTimedCell
+{
+	stCellPF*	pCell{ nullptr };
+	float		fArrive{ 0.f };			// enter time
+	float		fLeave{ 0.f };			// departure time, fLeave - fArrive = wait
+} stTimedCellPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SafeIntervalTable class
+
+/*
+* Schedule of the moving obstacles : busy intervals per cell, turned into the
+* sorted safe intervals (gaps) by Prepare. Two intervals conflict only when
+* they overlap, touching ends are allowed (follow a train one step behind).
+* Times are >= 0, SIPP_FOREVER = never ends.
+* Memory : 4 bytes per cell (slot) + 4 per busy cell + 12 per safe interval of
+* a busy cell, cells without obstacles have no interval stored.
+*/
+class SafeIntervalTable
+{
+public:
+	void Clear()
+	{
+		m_mapBusy.clear();
+		m_bDirty = true;
+	}
+
+	/* Cell (x, y) is occupied during [fBegin, fEnd], an empty interval blocks nothing */
+	void AddObstacle(const int x, const int y, const float fBegin, const float fEnd)
+	{
+		if (x < 0 || y < 0 || fEnd <= fBegin)
+			return;
+
+		m_mapBusy[Key(x, y)].push_back({ std::max(fBegin, 0.f), fEnd });
+		m_bDirty = true;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Obstacle walking consecutive cells (one move per waypoint)
+	*! @param  : [in] vecWay : cells with their arrive times, increasing times
+	*! @param  : [in] fHold  : time spent on the last cell (SIPP_FOREVER = parked)
+	*! @note   : cell i is busy from its arrive time to the arrive time on i + 1
+	*******************************************************************************/
+	void AddTrajectory(const std::vector<stTimedIdxPF>& vecWay, const float fHold = 0.f, const float fShift = 0.f)
+	{
+		for (size_t i = 0; i < vecWay.size(); i++)
+		{
+			float fBegin = vecWay[i].fTime + fShift;
+			float fEnd = (i + 1 < vecWay.size()) ? vecWay[i + 1].fTime + fShift :
+						 (fHold >= SIPP_FOREVER ? SIPP_FOREVER : fBegin + fHold);
+
+			AddObstacle(vecWay[i].stIdx.nX, vecWay[i].stIdx.nY, fBegin, fEnd);
+		}
+	}
+
+	/* Patrol : the trajectory repeated every fPeriod until fHorizon */
+	void AddPatrol(const std::vector<stTimedIdxPF>& vecWay, const float fPeriod, const float fHorizon)
+	{
+		if (vecWay.empty() || fPeriod <= 0.f)
+			return;
+
+		for (float fShift = 0.f; vecWay.front().fTime + fShift <= fHorizon; fShift += fPeriod)
+			AddTrajectory(vecWay, 0.f, fShift);
+	}
+
+	/*******************************************************************************
+	*! @brief  : Build the safe intervals of a board size (no-op when up to date)
+	*******************************************************************************/
+	void Prepare(const int nCols, const int nRows)
+	{
+		if (!m_bDirty && nCols == m_nCols && nRows == m_nRows)
+			return;
+
+		m_nCols = nCols;
+		m_nRows = nRows;
+		m_bDirty = false;
+
+		m_vecSlot.assign(size_t(nCols) * nRows, SIPP_NONE);
+		m_vecRange.assign(1, 0);
+		m_vecSafe.clear();
+		m_vecOwner.clear();
+
+		// key order : same state numbering for the same schedule
+		std::vector<uint64_t> vecKeys;
+		vecKeys.reserve(m_mapBusy.size());
+		for (auto& it : m_mapBusy)
+			vecKeys.push_back(it.first);
+		std::sort(vecKeys.begin(), vecKeys.end());
+
+		for (uint64_t nKey : vecKeys)
+		{
+			int x = int(nKey & 0xFFFFFFFFu), y = int(nKey >> 32);
+			if (x >= nCols || y >= nRows)
+				continue;
+
+			std::vector<stTimeIntervalPF>& vecBusy = m_mapBusy[nKey];
+			std::sort(vecBusy.begin(), vecBusy.end(), [](const stTimeIntervalPF& a, const stTimeIntervalPF& b)
+			{
+				return a.fBegin < b.fBegin;
+			});
+
+			float fFree = 0.f;
+			for (size_t i = 0; i < vecBusy.size(); i++)
+			{
+				if (vecBusy[i].fBegin > fFree)
+					m_vecSafe.push_back({ fFree, vecBusy[i].fBegin });
+
+				fFree = std::max(fFree, vecBusy[i].fEnd);
+				if (fFree >= SIPP_FOREVER)
+					break;
+			}
+
+			if (fFree < SIPP_FOREVER)
+				m_vecSafe.push_back({ fFree, SIPP_FOREVER });
+
+			size_t nCell = size_t(x) + size_t(y) * nCols;
+			m_vecOwner.resize(m_vecSafe.size(), (unsigned int)nCell);
+			m_vecSlot[nCell] = (unsigned int)(m_vecRange.size() - 1);
+			m_vecRange.push_back((unsigned int)m_vecSafe.size());
+		}
+	}
+
+	/* Safe intervals of a cell index : [nFirst, nLast) in Interval(), SIPP_NONE for an obstacle free cell */
+	void Intervals(const size_t nCell, unsigned int& nFirst, unsigned int& nLast) const noexcept
+	{
+		unsigned int nSlot = m_vecSlot[nCell];
+		if (nSlot == SIPP_NONE)
+		{
+			nFirst = nLast = SIPP_NONE;
+			return;
+		}
+
+		nFirst = m_vecRange[nSlot];
+		nLast = m_vecRange[nSlot + 1];
+	}
+
+	const stTimeIntervalPF& Interval(const unsigned int nInterval) const noexcept
+	{
+		return m_vecSafe[nInterval];
+	}
+
+	/* Cell index of a stored safe interval */
+	unsigned int IntervalCell(const unsigned int nInterval) const noexcept
+	{
+		return m_vecOwner[nInterval];
+	}
+
+	/* Number of stored safe intervals (state numbering of the search) */
+	size_t IntervalCount() const noexcept
+	{
+		return m_vecSafe.size();
+	}
+
+	/* No overlap between [fBegin, fEnd] and a busy interval of (x, y) */
+	bool IsSafe(const int x, const int y, const float fBegin, const float fEnd) const
+	{
+		auto it = m_mapBusy.find(Key(x, y));
+		if (it == m_mapBusy.end())
+			return true;
+
+		for (const stTimeIntervalPF& busy : it->second)
+		{
+			if (busy.fBegin < fEnd && fBegin < busy.fEnd)
+				return false;
+		}
+
+		return true;
+	}
+
+	size_t MemorySize() const noexcept
+	{
+		return m_vecSlot.capacity() * sizeof(unsigned int) + (m_vecRange.capacity() + m_vecOwner.capacity()) * sizeof(unsigned int) +
+			   m_vecSafe.capacity() * sizeof(stTimeIntervalPF);
+	}
+
+protected:
+	static uint64_t Key(const int x, const int y) noexcept
+	{
+		return (uint64_t(uint32_t(y)) << 32) | uint32_t(x);
+	}
+
+protected:
+	std::unordered_map<uint64_t, std::vector<stTimeIntervalPF>>	m_mapBusy;
+	bool							m_bDirty{ true };
+
+	// safe intervals of the busy cells
+	int								m_nCols{ 0 };
+	int								m_nRows{ 0 };
+	std::vector<unsigned int>		m_vecSlot;		// cell -> busy cell slot
+	std::vector<unsigned int>		m_vecRange;		// slot -> first interval
+	std::vector<stTimeIntervalPF>	m_vecSafe;
+	std::vector<unsigned int>		m_vecOwner;		// interval -> cell
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SafeIntervalSearch class
+
+/*
+* SIPP (Phillips & Likhachev) : a-star over (cell, safe interval) states with
+* the earliest arrive time as g. Waiting is folded into the moves so a cell
+* without obstacles is one state, the search stays close to a plain a-star
+* instead of one state per (cell, tick) of a time expanded a-star.
+* Moves and durations of a-star (1 / 1.412, cross, dont cross corners on the
+* static walls). A move leaving at t with duration m holds both cells during
+* [t, t + m], this also rejects the swap with an obstacle coming the other way.
+* Corner cells of a diagonal move are checked against static walls only.
+*/
+class SafeIntervalSearch : public PathFinding
+{
+	typedef struct _stSippNode
+	{
+		unsigned int	nGeneration{ 0 };
+		bool			bClosed{ false };
+		unsigned int	nPrev{ SIPP_NONE };
+		float			fTime{ SIPP_FOREVER };	// earliest arrive time
+	} stSippNodePF;
+
+	typedef struct _stSippOpen
+	{
+		float			fScore{ 0.f };
+		float			fTime{ 0.f };
+		unsigned int	nState{ 0 };
+
+		bool operator<(const _stSippOpen& other) const noexcept
+		{
+			if (fScore != other.fScore)
+				return fScore > other.fScore;
+
+			return fTime < other.fTime;
+		}
+	} stSippOpenPF;
+
+public:
+	void SetTable(SafeIntervalTable* pTable) noexcept
+	{
+		m_pTable = pTable;
+	}
+
+	/* Time of the agent on the start cell */
+	void SetStartTime(const float fStartTime) noexcept
+	{
+		m_fStartTime = std::max(fStartTime, 0.f);
+	}
+
+	/* true : the target must stay safe forever after the arrive (the agent stops there) */
+	void SetStayAtTarget(const bool bStay) noexcept
+	{
+		m_bStayAtTarget = bStay;
+	}
+
+	/* Timed path of the last query, empty if none */
+	const std::vector<stTimedCellPF>& TimedPath() const noexcept
+	{
+		return m_vecTimedPath;
+	}
+
+	/*******************************************************************************
+	*! @brief  : Earliest timed path from start (at fStartTime) to target
+	*! @param  : [out] vecPath : cells with arrive / leave times, start first
+	*! @return : true if found
+	*******************************************************************************/
+	bool Search(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target, const float fStartTime,
+				std::vector<stTimedCellPF>& vecPath)
+	{
+		vecPath.clear();
+
+		m_pGridBoard = pGridBoard;
+		if (!pGridBoard || !IsFree(start.nX, start.nY) || !IsFree(target.nX, target.nY))
+			return false;
+
+		m_bAllowCross = !pRefOption || pRefOption->m_bAllowCross;
+		m_bDontCrossCorners = pRefOption && pRefOption->m_bDontCrossCorners;
+		m_nCols = pGridBoard->Cols();
+
+		if (m_pTable)
+			m_pTable->Prepare(pGridBoard->Cols(), pGridBoard->Rows());
+
+		Prepare();
+
+		// start state : the interval holding the start time
+		size_t nStart = CellIndex(start.nX, start.nY);
+		unsigned int nFirst, nLast, nStartState = SIPP_NONE;
+		StateRange(nStart, nFirst, nLast);
+
+		for (unsigned int s = nFirst; s < nLast; s++)
+		{
+			const stTimeIntervalPF& safe = StateInterval(s);
+			if (safe.fBegin <= fStartTime && fStartTime <= safe.fEnd)
+			{
+				nStartState = s;
+				break;
+			}
+		}
+
+		if (nStartState == SIPP_NONE)
+			return false;
+
+		const int nDirs = m_bAllowCross ? 8 : 4;
+		static const int arDir[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+										 { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+		m_Open.Clear();
+
+		m_Records.Get(nStartState).fTime = fStartTime;
+		m_Open.Push({ fStartTime + Heuristic(start, target), fStartTime, nStartState });
+
+		unsigned int nGoal = SIPP_NONE;
+
+		while (!m_Open.Empty())
+		{
+			stSippOpenPF stOpen = m_Open.Pop();
+
+			stSippNodePF& node = m_Records.Get(stOpen.nState);
+			if (node.bClosed || stOpen.fTime > node.fTime)
+				continue;
+
+			node.bClosed = true;
+
+			stCellIdxPF idx = StateCell(stOpen.nState);
+			const stTimeIntervalPF stSafe = StateInterval(stOpen.nState);
+			StatsPop(pGridBoard->Get(idx));
+
+			if (idx.nX == target.nX && idx.nY == target.nY && (!m_bStayAtTarget || stSafe.fEnd >= SIPP_FOREVER))
+			{
+				nGoal = stOpen.nState;
+				break;
+			}
+
+			for (int d = 0; d < nDirs; d++)
+			{
+				int dx = arDir[d][0], dy = arDir[d][1];
+				if (!CanMove(idx.nX, idx.nY, dx, dy))
+					continue;
+
+				const float fMove = (d < 4) ? 1.f : 1.412f;
+				const stCellIdxPF next = { idx.nX + dx, idx.nY + dy };
+
+				StateRange(CellIndex(next.nX, next.nY), nFirst, nLast);
+
+				for (unsigned int s = nFirst; s < nLast; s++)
+				{
+					const stTimeIntervalPF& safe = StateInterval(s);
+					if (safe.fEnd < stOpen.fTime + fMove)
+						continue;
+
+					// leave as soon as the next cell is free, hold both cells while moving
+					float fLeave = std::max(stOpen.fTime, safe.fBegin);
+					float fArrive = fLeave + fMove;
+
+					if (fArrive > stSafe.fEnd)
+						break;
+
+					if (fArrive > safe.fEnd)
+						continue;
+
+					stSippNodePF& rec = m_Records.Get(s);
+					if (rec.bClosed || rec.fTime <= fArrive)
+						continue;
+
+					if (rec.fTime < SIPP_FOREVER)
+						StatsDecreaseKey(pGridBoard->Get(next));
+
+					rec.fTime = fArrive;
+					rec.nPrev = stOpen.nState;
+
+					m_Open.Push({ fArrive + Heuristic(next, target), fArrive, s });
+					StatsPush(pGridBoard->Get(next), m_Open.Size());
+				}
+			}
+		}
+
+		if (nGoal == SIPP_NONE)
+			return false;
+
+		for (unsigned int s = nGoal; s != SIPP_NONE; s = m_Records.Get(s).nPrev)
+		{
+			float fArrive = m_Records.Get(s).fTime;
+			vecPath.push_back({ pGridBoard->Get(StateCell(s)), fArrive, fArrive });
+		}
+
+		std::reverse(vecPath.begin(), vecPath.end());
+
+		for (size_t i = 0; i + 1 < vecPath.size(); i++)
+		{
+			const stCellIdxPF& a = vecPath[i].pCell->stIdx;
+			const stCellIdxPF& b = vecPath[i + 1].pCell->stIdx;
+			float fMove = (a.nX != b.nX && a.nY != b.nY) ? 1.412f : 1.f;
+			vecPath[i].fLeave = vecPath[i + 1].fArrive - fMove;
+		}
+
+		return true;
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		StatsBegin();
+
+		if (Search(pGridBoard, start, target, m_fStartTime, m_vecTimedPath))
+		{
+			path.reserve(m_vecTimedPath.size());
+			for (const stTimedCellPF& step : m_vecTimedPath)
+				path.push_back(step.pCell);
+		}
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	/*
+	* State numbering : cell index for a cell without obstacles (one interval
+	* [0, forever]), cell count + interval index for the safe intervals of the table
+	*/
+	void StateRange(const size_t nCell, unsigned int& nFirst, unsigned int& nLast) const noexcept
+	{
+		if (m_pTable)
+		{
+			m_pTable->Intervals(nCell, nFirst, nLast);
+			if (nFirst != SIPP_NONE)
+			{
+				nFirst += m_nCells;
+				nLast += m_nCells;
+				return;
+			}
+		}
+
+		nFirst = (unsigned int)nCell;
+		nLast = nFirst + 1;
+	}
+
+	stTimeIntervalPF StateInterval(const unsigned int nState) const noexcept
+	{
+		if (nState < m_nCells)
+			return stTimeIntervalPF();
+
+		return m_pTable->Interval(nState - m_nCells);
+	}
+
+	stCellIdxPF StateCell(const unsigned int nState) const noexcept
+	{
+		return nState < m_nCells ? CellIdx(nState) : CellIdx(m_pTable->IntervalCell(nState - m_nCells));
+	}
+
+	void Prepare()
+	{
+		m_nCells = (unsigned int)(size_t(m_pGridBoard->Cols()) * m_pGridBoard->Rows());
+		size_t szIntervals = m_pTable ? m_pTable->IntervalCount() : 0;
+
+		m_Records.Begin(m_nCells + szIntervals);
+	}
+
+	size_t CellIndex(const int x, const int y) const noexcept
+	{
+		return size_t(x) + size_t(y) * m_nCols;
+	}
+
+	stCellIdxPF CellIdx(const unsigned int nCell) const noexcept
+	{
+		return { int(nCell % m_nCols), int(nCell / m_nCols) };
+	}
+
+	float Heuristic(stCellIdxPF a, stCellIdxPF b) const noexcept
+	{
+		int dx = std::abs(a.nX - b.nX), dy = std::abs(a.nY - b.nY);
+
+		if (!m_bAllowCross)
+			return float(dx + dy);
+
+		return float(std::abs(dx - dy)) + 1.412f * float(std::min(dx, dy));
+	}
+
+	bool IsFree(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_pGridBoard->Cols() || y >= m_pGridBoard->Rows())
+			return false;
+
+		stCellPF* pCell = m_pGridBoard->Get(x, y);
+		return pCell && pCell->stData.fWeight <= 0;
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (!IsFree(x + dx, y + dy))
+			return false;
+
+		if (dx == 0 || dy == 0)
+			return true;
+
+		bool bSide1 = IsFree(x + dx, y);
+		bool bSide2 = IsFree(x, y + dy);
+
+		return m_bDontCrossCorners ? (bSide1 && bSide2) : (bSide1 || bSide2);
+	}
+
+protected:
+	SafeIntervalTable*				m_pTable{ nullptr };
+	float							m_fStartTime{ 0.f };
+	bool							m_bStayAtTarget{ true };
+	std::vector<stTimedCellPF>		m_vecTimedPath;
+
+	// query
+	GridPF*							m_pGridBoard{ nullptr };
+	bool							m_bAllowCross{ true };
+	bool							m_bDontCrossCorners{ false };
+	int								m_nCols{ 0 };
+	unsigned int					m_nCells{ 0 };
+
+	// search
+	SearchRecords<stSippNodePF>		m_Records;
+	SearchOpenList<stSippOpenPF>	m_Open;
+};
+
+#endif // !XSIPP_H
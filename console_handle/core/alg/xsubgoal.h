@@ -0,0 +1,788 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Simple and two-level subgoal graphs (optimal 8-connected on static maps)
+* @file  : xsubgoal.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XSUBGOAL_H
+#define XSUBGOAL_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "xastar.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define SUBGOAL_NONE	UINT32_MAX
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stSubgoalEdge
+{
+	unsigned int nTo{ SUBGOAL_NONE };
+	unsigned int nVia{ SUBGOAL_NONE };		// two-level edge : shortest path through this subgoal
+} stSubgoalEdgePF;
+
+typedef struct _stSubgoalDist
+{
+	unsigned int nGeneration{ 0 };
+	float		 fDist{ -1.f };			// < 0 : not reached
+} stSubgoalDistPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SubgoalGraph class
+
+/*
+* Subgoals are the free cells at convex obstacle corners. Two subgoals are
+* linked when one is reachable from the other by a diagonal-then-straight
+* move without passing another subgoal (direct h-reachable), the shortest
+* path is then the octile distance.
+* Two-level : a subgoal only needed to join its neighbors is made local,
+* its neighbors get a direct edge instead. Queries only visit the global
+* subgoals and the local ones linked to the start or the target.
+* Movement : 8 directions, a diagonal move needs both side cells free.
+*/
+class SubgoalGraph
+{
+public:
+	/* nThreads 0 : all hardware threads */
+	bool Build(GridPF* pGridBoard, const bool bTwoLevel = true, const unsigned int nThreads = 0)
+	{
+		Clear();
+
+		if (!pGridBoard || pGridBoard->Length() == 0)
+			return false;
+
+		ReadBoard(pGridBoard);
+
+		// Subgoals
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				if (!IsCorner(x, y))
+					continue;
+
+				m_vecSubgoalAt[x + size_t(y) * m_nCols] = (unsigned int)m_vecNodes.size();
+				m_vecNodes.push_back({ x, y });
+			}
+		}
+
+		unsigned int nCount = (unsigned int)m_vecNodes.size();
+		m_vecEdges.assign(nCount, std::vector<stSubgoalEdgePF>());
+		m_vecGlobal.assign(nCount, 1);
+
+		// Direct h-reachable subgoals of each subgoal (independent, split over threads)
+		std::vector<std::vector<unsigned int>> vecReach(nCount);
+
+		util::parallel_for(0, nCount, [&](size_t nBegin, size_t nEnd, unsigned int)
+		{
+			bool bExtra = false;
+			for (size_t i = nBegin; i < nEnd; i++)
+				DirectHReachable(m_vecNodes[i], vecReach[i], nullptr, bExtra);
+		}, nThreads);
+
+		// Undirected edges
+		for (unsigned int i = 0; i < nCount; i++)
+		{
+			for (unsigned int j : vecReach[i])
+			{
+				if (j != i && !HasEdge(i, j))
+				{
+					m_vecEdges[i].push_back({ j, SUBGOAL_NONE });
+					m_vecEdges[j].push_back({ i, SUBGOAL_NONE });
+				}
+			}
+		}
+
+		if (bTwoLevel)
+			MakeTwoLevel();
+
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = 0;
+		m_vecBlocked.clear();
+		m_vecSubgoalAt.clear();
+		m_vecNodes.clear();
+		m_vecEdges.clear();
+		m_vecGlobal.clear();
+	}
+
+public:
+	bool IsValid(GridPF* pGridBoard) const noexcept
+	{
+		return pGridBoard && m_pGridBoard == pGridBoard && m_nGridVersion == pGridBoard->Version();
+	}
+
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	size_t NodeCount() const noexcept { return m_vecNodes.size(); }
+	const stCellIdxPF& Node(const unsigned int nNode) const noexcept { return m_vecNodes[nNode]; }
+	const std::vector<stSubgoalEdgePF>& Edges(const unsigned int nNode) const noexcept { return m_vecEdges[nNode]; }
+	bool IsGlobal(const unsigned int nNode) const noexcept { return m_vecGlobal[nNode] != 0; }
+
+	size_t GlobalCount() const noexcept
+	{
+		return (size_t)std::count(m_vecGlobal.begin(), m_vecGlobal.end(), 1);
+	}
+
+	bool IsBlocked(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return true;
+
+		return m_vecBlocked[x + size_t(y) * m_nCols] != 0;
+	}
+
+	unsigned int SubgoalAt(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return SUBGOAL_NONE;
+
+		return m_vecSubgoalAt[x + size_t(y) * m_nCols];
+	}
+
+	bool CanMove(const int x, const int y, const int dx, const int dy) const noexcept
+	{
+		if (IsBlocked(x + dx, y + dy))
+			return false;
+
+		return dx == 0 || dy == 0 || (!IsBlocked(x + dx, y) && !IsBlocked(x, y + dy));
+	}
+
+	static float GetDistance(const stCellIdxPF& a, const stCellIdxPF& b) noexcept
+	{
+		int dx = std::abs(a.nX - b.nX);
+		int dy = std::abs(a.nY - b.nY);
+
+		return 1.f * std::abs(dx - dy) + 1.412f * std::min(dx, dy);
+	}
+
+	/*
+	* Subgoals reachable from s by a diagonal-then-straight move without
+	* passing another subgoal. pExtra is treated as a subgoal, bExtra tells
+	* whether it was reached.
+	*/
+	void DirectHReachable(const stCellIdxPF& s, std::vector<unsigned int>& vecReach,
+						  const stCellIdxPF* pExtra, bool& bExtra) const
+	{
+		vecReach.clear();
+		bExtra = false;
+
+		auto funReach = [&](const int x, const int y)
+		{
+			if (pExtra && x == pExtra->nX && y == pExtra->nY)
+				bExtra = true;
+			else
+				vecReach.push_back(SubgoalAt(x, y));
+		};
+
+		int nStopX, nStopY;
+
+		for (int d = 0; d < 4; d++)
+		{
+			const int dx = (d == 0) - (d == 1);
+			const int dy = (d == 2) - (d == 3);
+
+			Clearance(s.nX, s.nY, dx, dy, pExtra, nStopX, nStopY);
+			if (nStopX >= 0)
+				funReach(nStopX, nStopY);
+		}
+
+		for (int dy = -1; dy <= 1; dy += 2)
+		{
+			for (int dx = -1; dx <= 1; dx += 2)
+			{
+				int nMaxX = Clearance(s.nX, s.nY, dx, 0, pExtra, nStopX, nStopY);
+				int nMaxY = Clearance(s.nX, s.nY, 0, dy, pExtra, nStopX, nStopY);
+
+				int nDiag = Clearance(s.nX, s.nY, dx, dy, pExtra, nStopX, nStopY);
+				if (nStopX >= 0)
+					funReach(nStopX, nStopY);
+
+				for (int i = 1; i <= nDiag; i++)
+				{
+					int x = s.nX + i * dx, y = s.nY + i * dy;
+
+					int j = Clearance(x, y, dx, 0, pExtra, nStopX, nStopY);
+					if (j <= nMaxX && nStopX >= 0)
+					{
+						funReach(nStopX, nStopY);
+						j--;
+					}
+					nMaxX = std::min(nMaxX, j);
+
+					j = Clearance(x, y, 0, dy, pExtra, nStopX, nStopY);
+					if (j <= nMaxY && nStopX >= 0)
+					{
+						funReach(nStopX, nStopY);
+						j--;
+					}
+					nMaxY = std::min(nMaxY, j);
+				}
+			}
+		}
+	}
+
+protected:
+	/*
+	* Number of moves from (x, y) along (dx, dy) before an obstacle or a
+	* subgoal, the subgoal stopping the walk is returned in nStopX/Y (-1 : none)
+	*/
+	int Clearance(int x, int y, const int dx, const int dy, const stCellIdxPF* pExtra,
+				  int& nStopX, int& nStopY) const noexcept
+	{
+		nStopX = nStopY = -1;
+
+		int nSteps = 0;
+		while (CanMove(x, y, dx, dy))
+		{
+			x += dx;
+			y += dy;
+
+			if (SubgoalAt(x, y) != SUBGOAL_NONE || (pExtra && x == pExtra->nX && y == pExtra->nY))
+			{
+				nStopX = x;
+				nStopY = y;
+				break;
+			}
+
+			nSteps++;
+		}
+
+		return nSteps;
+	}
+
+	bool HasEdge(const unsigned int a, const unsigned int b) const noexcept
+	{
+		for (auto& edge : m_vecEdges[a])
+		{
+			if (edge.nTo == b)
+				return true;
+		}
+
+		return false;
+	}
+
+	void RemoveEdge(const unsigned int a, const unsigned int b)
+	{
+		auto& vecEdges = m_vecEdges[a];
+		vecEdges.erase(std::remove_if(vecEdges.begin(), vecEdges.end(),
+			[b](const stSubgoalEdgePF& edge) { return edge.nTo == b; }), vecEdges.end());
+	}
+
+	/*
+	* Subgoal s becomes local when every pair of its neighbors either lies on
+	* an h-reachable line through s (a direct edge replaces it) or has another
+	* path as short avoiding s and the local subgoals
+	*/
+	void MakeTwoLevel()
+	{
+		unsigned int nCount = (unsigned int)m_vecNodes.size();
+
+		std::vector<std::pair<unsigned int, unsigned int>> vecAdd;
+
+		for (unsigned int s = 0; s < nCount; s++)
+		{
+			const auto& vecEdges = m_vecEdges[s];
+			bool bNecessary = false;
+			vecAdd.clear();
+
+			for (size_t i = 0; i < vecEdges.size() && !bNecessary; i++)
+			{
+				unsigned int p = vecEdges[i].nTo;
+				float fToS = GetDistance(m_vecNodes[p], m_vecNodes[s]);
+				bool bSearched = false;
+
+				for (size_t j = i + 1; j < vecEdges.size() && !bNecessary; j++)
+				{
+					unsigned int q = vecEdges[j].nTo;
+					float fVia = fToS + GetDistance(m_vecNodes[s], m_vecNodes[q]);
+
+					if (GetDistance(m_vecNodes[p], m_vecNodes[q]) + 1e-3f >= fVia)
+					{
+						if (!HasEdge(p, q))
+							vecAdd.push_back({ p, q });
+
+						continue;
+					}
+
+					// One search from p serves all the q
+					if (!bSearched)
+					{
+						SearchAvoiding(p, s, fToS + MaxNeighborDistance(s));
+						bSearched = true;
+					}
+
+					if (!m_Dist.IsCurrent(q) || m_Dist[q].fDist > fVia + 1e-3f)
+						bNecessary = true;
+				}
+			}
+
+			if (bNecessary)
+				continue;
+
+			for (auto& pair : vecAdd)
+			{
+				if (HasEdge(pair.first, pair.second))
+					continue;
+
+				m_vecEdges[pair.first].push_back({ pair.second, s });
+				m_vecEdges[pair.second].push_back({ pair.first, s });
+			}
+
+			m_vecGlobal[s] = 0;
+		}
+	}
+
+	float MaxNeighborDistance(const unsigned int s) const noexcept
+	{
+		float fMax = 0.f;
+		for (auto& edge : m_vecEdges[s])
+			fMax = std::max(fMax, GetDistance(m_vecNodes[s], m_vecNodes[edge.nTo]));
+
+		return fMax;
+	}
+
+	/*
+	* Bounded Dijkstra from p without s, through the global subgoals only
+	* (local subgoals are reached but not expanded)
+	*/
+	void SearchAvoiding(const unsigned int p, const unsigned int s, const float fBound)
+	{
+		typedef std::pair<float, unsigned int> OpenItem;
+
+		m_Dist.Begin(m_vecNodes.size());
+		m_DistOpen.Clear();
+
+		m_Dist.Get(p).fDist = 0.f;
+		m_DistOpen.Push({ -0.f, p });
+
+		while (!m_DistOpen.Empty())
+		{
+			OpenItem item = m_DistOpen.Pop();
+
+			unsigned int u = item.second;
+			float fDist = -item.first;
+
+			if (fDist > m_Dist[u].fDist)
+				continue;
+
+			if (u != p && !m_vecGlobal[u])
+				continue;
+
+			for (auto& edge : m_vecEdges[u])
+			{
+				unsigned int v = edge.nTo;
+				if (v == s)
+					continue;
+
+				float fNext = fDist + GetDistance(m_vecNodes[u], m_vecNodes[v]);
+				if (fNext > fBound + 1e-3f)
+					continue;
+
+				stSubgoalDistPF& dist = m_Dist.Get(v);
+				if (dist.fDist >= 0.f && dist.fDist <= fNext)
+					continue;
+
+				dist.fDist = fNext;
+				m_DistOpen.Push({ -fNext, v });
+			}
+		}
+	}
+
+	void ReadBoard(GridPF* pGridBoard)
+	{
+		m_nCols = pGridBoard->Cols();
+		m_nRows = pGridBoard->Rows();
+		m_vecBlocked.assign(size_t(m_nCols) * m_nRows, 0);
+		m_vecSubgoalAt.assign(size_t(m_nCols) * m_nRows, SUBGOAL_NONE);
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = pGridBoard->Get(x, y);
+				m_vecBlocked[x + size_t(y) * m_nCols] = (!pCell || pCell->stData.fWeight > 0) ? 1 : 0;
+			}
+		}
+	}
+
+	/* Free cell diagonal to an obstacle with both side cells free */
+	bool IsCorner(const int x, const int y) const noexcept
+	{
+		if (IsBlocked(x, y))
+			return false;
+
+		for (int dy = -1; dy <= 1; dy += 2)
+		{
+			for (int dx = -1; dx <= 1; dx += 2)
+			{
+				if (x + dx < 0 || y + dy < 0 || x + dx >= m_nCols || y + dy >= m_nRows)
+					continue;
+
+				if (IsBlocked(x + dx, y + dy) && !IsBlocked(x + dx, y) && !IsBlocked(x, y + dy))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+protected:
+	GridPF*										m_pGridBoard{ nullptr };
+	unsigned int								m_nGridVersion{ 0 };
+	int											m_nCols{ 0 };
+	int											m_nRows{ 0 };
+	std::vector<uint8_t>						m_vecBlocked;
+	std::vector<unsigned int>					m_vecSubgoalAt;
+
+	std::vector<stCellIdxPF>					m_vecNodes;
+	std::vector<std::vector<stSubgoalEdgePF>>	m_vecEdges;
+	std::vector<uint8_t>						m_vecGlobal;
+
+	// two-level build
+	SearchRecords<stSubgoalDistPF>				m_Dist;
+	SearchOpenList<std::pair<float, unsigned int>> m_DistOpen;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// SubgoalSearch class
+
+/*
+* A-star over the subgoal graph, then each edge is expanded back into cells.
+* The graph models m_bAllowCross with m_bDontCrossCorners only (UsesGraph),
+* other options run a plain a-star : the default PathFinderOption cuts
+* corners, set m_bDontCrossCorners to search the graph.
+*/
+class SubgoalSearch : public PathFinding
+{
+	typedef struct _stSubgoalSearchNode
+	{
+		unsigned int	nGeneration{ 0 };
+		bool			bClosed{ false };
+		uint8_t			nLink{ 0 };		// 1 : linked to the target, 2 : linked to the start
+		unsigned int	nPrev{ SUBGOAL_NONE };
+		float			fCost{ -1.f };		// < 0 : not reached
+	} stSubgoalSearchNodePF;
+
+	typedef struct _stSubgoalOpen
+	{
+		float			fScore{ 0.f };
+		unsigned int	nNode{ 0 };
+
+		bool operator<(const _stSubgoalOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stSubgoalOpenPF;
+
+public:
+	/* External graph (Build first), nullptr : internal graph built on demand */
+	void SetGraph(SubgoalGraph* pGraph) noexcept
+	{
+		m_pGraph = pGraph;
+	}
+
+	/* Level of the internal graph */
+	void SetTwoLevel(const bool bTwoLevel) noexcept
+	{
+		m_bTwoLevel = bTwoLevel;
+		m_Graph.Clear();
+	}
+
+	SubgoalGraph* GetGraph() noexcept
+	{
+		return m_pGraph ? m_pGraph : &m_Graph;
+	}
+
+	/* Searches with this option go through the graph (otherwise plain a-star) */
+	static bool UsesGraph(const PathFinderOption* pOption) noexcept
+	{
+		return !pOption || (pOption->m_bAllowCross && pOption->m_bDontCrossCorners);
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		if (!pGridBoard)
+			return path;
+
+		if (!UsesGraph(pRefOption))
+		{
+			m_Fallback.SetOption(*pRefOption);
+			m_Fallback.Prepar(pGridBoard, &m_AStar);
+			return m_Fallback.Search(start, target);
+		}
+
+		SubgoalGraph* pGraph = m_pGraph;
+		if (!pGraph || !pGraph->IsValid(pGridBoard))
+		{
+			pGraph = &m_Graph;
+			if (!pGraph->IsValid(pGridBoard))
+				pGraph->Build(pGridBoard, m_bTwoLevel);
+		}
+
+		StatsBegin();
+
+		if (Search(pGraph, pGridBoard, start, target) && !MakePath(pGraph, pGridBoard, start, target, path))
+			path.clear();
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	const stCellIdxPF& NodeIdx(SubgoalGraph* pGraph, const unsigned int nNode,
+							   const stCellIdxPF& start, const stCellIdxPF& target) const
+	{
+		unsigned int nCount = (unsigned int)pGraph->NodeCount();
+
+		if (nNode == nCount)
+			return start;
+
+		return nNode == nCount + 1 ? target : pGraph->Node(nNode);
+	}
+
+	void Relax(SubgoalGraph* pGraph, GridPF* pGridBoard, const unsigned int nFrom, const unsigned int nTo,
+			   const float fCost, const stCellIdxPF& start, const stCellIdxPF& target)
+	{
+		stSubgoalSearchNodePF& rec = m_Records.Get(nTo);
+		if (rec.bClosed || (rec.fCost >= 0.f && rec.fCost <= fCost))
+			return;
+
+		const stCellIdxPF& idx = NodeIdx(pGraph, nTo, start, target);
+
+		if (rec.fCost >= 0.f)
+			StatsDecreaseKey(pGridBoard->Get(idx));
+
+		rec.fCost = fCost;
+		rec.nPrev = nFrom;
+
+		m_Open.Push({ fCost + SubgoalGraph::GetDistance(idx, target), nTo });
+		StatsPush(pGridBoard->Get(idx), m_Open.Size());
+	}
+
+	bool Search(SubgoalGraph* pGraph, GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		if (pGraph->IsBlocked(start.nX, start.nY) || pGraph->IsBlocked(target.nX, target.nY))
+			return false;
+
+		unsigned int nCount = (unsigned int)pGraph->NodeCount();
+		unsigned int nStartNode = nCount;
+		unsigned int nTargetNode = nCount + 1;
+
+		m_Records.Begin(size_t(nCount) + 2);
+		m_Open.Clear();
+		m_Records.Get(nStartNode).fCost = 0.f;
+		m_Records.Get(nStartNode).bClosed = true;
+
+		if (start.nX == target.nX && start.nY == target.nY)
+		{
+			m_Records.Get(nTargetNode).nPrev = nStartNode;
+			return true;
+		}
+
+		// Subgoals linked to the target and to the start
+		bool bExtra = false;
+		pGraph->DirectHReachable(target, m_vecReach, nullptr, bExtra);
+		for (unsigned int n : m_vecReach)
+			m_Records.Get(n).nLink |= 1;
+
+		pGraph->DirectHReachable(start, m_vecReach, &target, bExtra);
+		for (unsigned int n : m_vecReach)
+			m_Records.Get(n).nLink |= 2;
+
+		if (bExtra)
+			Relax(pGraph, pGridBoard, nStartNode, nTargetNode, SubgoalGraph::GetDistance(start, target), start, target);
+
+		for (unsigned int n : m_vecReach)
+			Relax(pGraph, pGridBoard, nStartNode, n, SubgoalGraph::GetDistance(start, pGraph->Node(n)), start, target);
+
+		while (!m_Open.Empty())
+		{
+			stSubgoalOpenPF stOpen = m_Open.Pop();
+
+			stSubgoalSearchNodePF& rec = m_Records.Get(stOpen.nNode);
+			if (rec.bClosed)
+				continue;
+
+			rec.bClosed = true;
+
+			if (stOpen.nNode == nTargetNode)
+				return true;
+
+			const stCellIdxPF& idx = pGraph->Node(stOpen.nNode);
+			StatsPop(pGridBoard->Get(idx));
+
+			float fCost = rec.fCost;
+
+			if (rec.nLink & 1)
+				Relax(pGraph, pGridBoard, stOpen.nNode, nTargetNode, fCost + SubgoalGraph::GetDistance(idx, target), start, target);
+
+			for (auto& edge : pGraph->Edges(stOpen.nNode))
+			{
+				// Local subgoals only when linked to the start or the target
+				if (!pGraph->IsGlobal(edge.nTo) && !m_Records.Get(edge.nTo).nLink)
+					continue;
+
+				Relax(pGraph, pGridBoard, stOpen.nNode, edge.nTo,
+					  fCost + SubgoalGraph::GetDistance(idx, pGraph->Node(edge.nTo)), start, target);
+			}
+		}
+
+		return false;
+	}
+
+	/* Cells from a to b (h-reachable), the first cell is not added */
+	bool AddMove(SubgoalGraph* pGraph, GridPF* pGridBoard, const stCellIdxPF& a, const stCellIdxPF& b,
+				 std::vector<stCellPF*>& path)
+	{
+		size_t szMark = path.size();
+
+		// Diagonal first from a, then diagonal first from b (reversed)
+		for (int nTry = 0; nTry < 2; nTry++)
+		{
+			const stCellIdxPF& s = nTry ? b : a;
+			const stCellIdxPF& e = nTry ? a : b;
+
+			int x = s.nX, y = s.nY;
+			bool bOk = true;
+
+			m_vecMove.clear();
+			while (x != e.nX || y != e.nY)
+			{
+				int dx = (e.nX > x) - (e.nX < x);
+				int dy = (e.nY > y) - (e.nY < y);
+
+				if (!pGraph->CanMove(x, y, dx, dy))
+				{
+					bOk = false;
+					break;
+				}
+
+				x += dx;
+				y += dy;
+				m_vecMove.push_back({ x, y });
+			}
+
+			if (!bOk)
+				continue;
+
+			if (nTry)
+			{
+				// b -> a cells reversed : drop a, append b
+				if (!m_vecMove.empty())
+					m_vecMove.pop_back();
+
+				std::reverse(m_vecMove.begin(), m_vecMove.end());
+				m_vecMove.push_back(b);
+			}
+
+			for (auto& idx : m_vecMove)
+				path.push_back(pGridBoard->Get(idx));
+
+			return true;
+		}
+
+		path.resize(szMark);
+		return false;
+	}
+
+	/* Expand a graph edge, two-level edges go through their via subgoal */
+	bool AddEdge(SubgoalGraph* pGraph, GridPF* pGridBoard, const stCellIdxPF& a, const stCellIdxPF& b,
+				 const unsigned int nA, const unsigned int nB, std::vector<stCellPF*>& path, int nDepth = 0)
+	{
+		if (AddMove(pGraph, pGridBoard, a, b, path))
+			return true;
+
+		unsigned int nVia = SUBGOAL_NONE;
+
+		if (nA != SUBGOAL_NONE && nB != SUBGOAL_NONE)
+		{
+			for (auto& edge : pGraph->Edges(nA))
+			{
+				if (edge.nTo == nB)
+				{
+					nVia = edge.nVia;
+					break;
+				}
+			}
+		}
+
+		if (nVia == SUBGOAL_NONE || nDepth >= 64)
+			return false;
+
+		const stCellIdxPF& v = pGraph->Node(nVia);
+
+		return AddEdge(pGraph, pGridBoard, a, v, nA, nVia, path, nDepth + 1) &&
+			   AddEdge(pGraph, pGridBoard, v, b, nVia, nB, path, nDepth + 1);
+	}
+
+	/* false : an edge could not be expanded into cells (path left incomplete) */
+	bool MakePath(SubgoalGraph* pGraph, GridPF* pGridBoard, const stCellIdxPF& start,
+				  const stCellIdxPF& target, std::vector<stCellPF*>& path)
+	{
+		unsigned int nCount = (unsigned int)pGraph->NodeCount();
+		unsigned int nTargetNode = nCount + 1;
+
+		m_vecChain.clear();
+		for (unsigned int n = nTargetNode; n != SUBGOAL_NONE; n = m_Records[n].nPrev)
+			m_vecChain.push_back(n);
+
+		std::reverse(m_vecChain.begin(), m_vecChain.end());
+
+		path.push_back(pGridBoard->Get(start));
+
+		for (size_t i = 0; i + 1 < m_vecChain.size(); i++)
+		{
+			unsigned int nA = m_vecChain[i], nB = m_vecChain[i + 1];
+
+			if (!AddEdge(pGraph, pGridBoard, NodeIdx(pGraph, nA, start, target), NodeIdx(pGraph, nB, start, target),
+						 nA < nCount ? nA : SUBGOAL_NONE, nB < nCount ? nB : SUBGOAL_NONE, path))
+				return false;
+		}
+
+		return true;
+	}
+
+protected:
+	SubgoalGraph*						m_pGraph{ nullptr };
+	SubgoalGraph						m_Graph;
+	bool								m_bTwoLevel{ true };
+
+	// other movement rules
+	AStar								m_AStar;
+	PathFinder							m_Fallback;
+
+	// search
+	SearchRecords<stSubgoalSearchNodePF>	m_Records;
+	SearchOpenList<stSubgoalOpenPF>		m_Open;
+	std::vector<unsigned int>			m_vecReach;
+	std::vector<unsigned int>			m_vecChain;
+	std::vector<stCellIdxPF>			m_vecMove;
+};
+
+#endif // !XSUBGOAL_H
@@ -35,6 +35,8 @@ class ThetaStar : public AStar
 		dx = abs(dx);
 		dy = abs(dy);
 
+		StatsLosCheck();
+
 		auto funIsMoveable = [this](int x, int y)
 		{
 			stAStarCellPF* pCellCur = GetCell(x, y);
@@ -132,76 +134,9 @@ class ThetaStar : public AStar
 		}
 	}
 
-	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	virtual void OnCellPushed(stAStarCellPF* pCell)
 	{
-		stAStarCellPF* pCellCur, * pNextCell, * pCellStart, * pCellTarget;
-		float fDisNext2Dest, fDisTraveled = 0.f;
-		std::vector<stCellPF*> path;
-
-		stCellIdxPF stIdx;
-
-		if (!Prepar(pGridBoard))
-			return path;
-
-		pCellCur = pCellStart = GetCell(start);
-		pCellTarget = GetCell(target);
-
-		UpdateWayPriority(start, target);
-
-		PushToPriorityQuery(pCellStart, 0.f, 0.f, nullptr);
-
-		size_t nLoop = 0, nMaxStep = pGridBoard->Length();
-
-		while (pCellCur && nLoop++ <= nMaxStep)
-		{
-			if (pCellCur == pCellTarget)
-				break;
-
-			for (int i = 0; i < m_nWayDirection; i++)
-			{
-				if (m_arWayDirection[i].w > 0.0001)
-				{
-					stIdx.nX = pCellCur->pGrid->stIdx.nX + m_arWayDirection[i].x;
-					stIdx.nY = pCellCur->pGrid->stIdx.nY + m_arWayDirection[i].y;
-
-					pNextCell = GetCell(stIdx);
-
-					if (pNextCell == nullptr)
-						continue;
-
-					fDisTraveled = pCellCur->fDistanceSrc +
-						(IsCrossCell(pCellCur->pGrid->stIdx, stIdx) ? 1.412f : 1.f);
-
-					fDisNext2Dest = IsCellMoveableTo(pCellCur, pNextCell) && (pCellCur->pPrev != pNextCell) ?
-						GetDistance(pNextCell, pCellTarget) : -1.f;
-
-					if (fDisNext2Dest >= 0)
-					{
-						if (PushToPriorityQuery(pNextCell, fDisTraveled, fDisNext2Dest, pCellCur))
-						{
-							OptimizePriorityQuery(pNextCell->pGrid->stIdx);
-						}
-					}
-				}
-			}
-
-			pCellCur = PopCellPriorityQuery();
-
-			if (m_pFunPerform)
-			{
-				m_pFunPerform(m_GridCellUniqueManager, pCellCur->pGrid);
-			}
-
-			UpdateWayPriority(pCellCur->pGrid->stIdx, target);
-		}
-
-		// get path if exist
-		if (pCellCur == pCellTarget)
-		{
-			path = GetPath(pCellTarget);
-		}
-
-		return path;
+		OptimizePriorityQuery(pCell->pGrid->stIdx);
 	}
 };
 
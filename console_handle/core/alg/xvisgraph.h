@@ -0,0 +1,616 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Visibility graph over obstacle corners (any-angle on static maps)
+* @file  : xvisgraph.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XVISGRAPH_H
+#define XVISGRAPH_H
+
+#include <stdio.h>
+#include <share.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include "xpathfinder.h"
+#include "xsearchscratch.h"
+#include "com/xparallel.h"
+
+#define VISGRAPH_MAGIC		0x46504756u		// 'VGPF'
+#define VISGRAPH_VERSION	1u
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// Common struct
+
+typedef struct _stVisGraphHeader
+{
+	uint32_t nMagic{ VISGRAPH_MAGIC };
+	uint32_t nVersion{ VISGRAPH_VERSION };
+	uint32_t nCols{ 0 };
+	uint32_t nRows{ 0 };
+	uint64_t nBoardHash{ 0 };		// obstacle layout the graph was built from
+	uint32_t nNodes{ 0 };
+	uint32_t nEdges{ 0 };
+} stVisGraphHeaderPF;
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// VisibilityGraph class
+
+/*
+* Nodes are the free cells at a convex obstacle corner (a blocked diagonal
+* cell with both side cells free), edges join the corners in line of sight
+* (exact segment test between cell centers). Shortest any-angle paths
+* only turn next to obstacle corners.
+* Build : O(corners^2) line tests, split over threads.
+* Memory : compressed adjacency, 8 bytes per directed edge.
+*/
+class VisibilityGraph
+{
+public:
+	/* nThreads 0 : all hardware threads */
+	bool Build(GridPF* pGridBoard, const unsigned int nThreads = 0)
+	{
+		Clear();
+
+		if (!pGridBoard || pGridBoard->Length() == 0)
+			return false;
+
+		ReadBoard(pGridBoard);
+		FindCorners();
+
+		unsigned int nCount = (unsigned int)m_vecNodes.size();
+		unsigned int nWorkers = util::thread_count(nThreads);
+
+		// Interleaved rows of the upper triangle keep the threads balanced
+		std::vector<std::vector<std::pair<unsigned int, unsigned int>>> vecThreadEdges(nWorkers);
+
+		util::parallel_for(0, nWorkers, [&](size_t nBegin, size_t nEnd, unsigned int)
+		{
+			for (size_t t = nBegin; t < nEnd; t++)
+			{
+				auto& vecEdges = vecThreadEdges[t];
+				for (unsigned int i = (unsigned int)t; i < nCount; i += nWorkers)
+				{
+					for (unsigned int j = i + 1; j < nCount; j++)
+					{
+						if (IsVisible(m_vecNodes[i], m_vecNodes[j]))
+							vecEdges.push_back({ i, j });
+					}
+				}
+			}
+		}, nWorkers);
+
+		// Compressed adjacency, both directions
+		m_vecOffsets.assign(size_t(nCount) + 1, 0);
+		for (auto& vecEdges : vecThreadEdges)
+		{
+			for (auto& edge : vecEdges)
+			{
+				m_vecOffsets[edge.first + 1]++;
+				m_vecOffsets[edge.second + 1]++;
+			}
+		}
+
+		for (unsigned int i = 0; i < nCount; i++)
+			m_vecOffsets[i + 1] += m_vecOffsets[i];
+
+		m_vecEdges.resize(m_vecOffsets[nCount]);
+		m_vecEdgeCost.resize(m_vecOffsets[nCount]);
+
+		std::vector<unsigned int> vecFill(m_vecOffsets.begin(), m_vecOffsets.end() - 1);
+		for (auto& vecEdges : vecThreadEdges)
+		{
+			for (auto& edge : vecEdges)
+			{
+				float fCost = GetDistance(m_vecNodes[edge.first], m_vecNodes[edge.second]);
+
+				m_vecEdges[vecFill[edge.first]] = edge.second;
+				m_vecEdgeCost[vecFill[edge.first]++] = fCost;
+				m_vecEdges[vecFill[edge.second]] = edge.first;
+				m_vecEdgeCost[vecFill[edge.second]++] = fCost;
+			}
+		}
+
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_pGridBoard = nullptr;
+		m_nCols = m_nRows = 0;
+		m_nBoardHash = 0;
+		m_vecBlocked.clear();
+		m_vecNodes.clear();
+		m_vecOffsets.clear();
+		m_vecEdges.clear();
+		m_vecEdgeCost.clear();
+	}
+
+public:
+	/* Graph matches the current board */
+	bool IsValid(GridPF* pGridBoard) const noexcept
+	{
+		return pGridBoard && m_pGridBoard == pGridBoard && m_nGridVersion == pGridBoard->Version();
+	}
+
+	GridPF* Grid() const noexcept { return m_pGridBoard; }
+	size_t NodeCount() const noexcept { return m_vecNodes.size(); }
+	size_t EdgeCount() const noexcept { return m_vecEdges.size() / 2; }
+	const stCellIdxPF& Node(const unsigned int nNode) const noexcept { return m_vecNodes[nNode]; }
+
+	bool IsBlocked(const int x, const int y) const noexcept
+	{
+		if (x < 0 || y < 0 || x >= m_nCols || y >= m_nRows)
+			return true;
+
+		return m_vecBlocked[x + size_t(y) * m_nCols] != 0;
+	}
+
+	/*
+	* Line of sight between two cell centers : the segment does not enter a
+	* blocked cell nor squeeze between two blocked cells touching by a corner
+	*/
+	bool IsVisible(const stCellIdxPF& a, const stCellIdxPF& b) const noexcept
+	{
+		int x = a.nX, y = a.nY;
+		int dx = std::abs(b.nX - a.nX), dy = std::abs(b.nY - a.nY);
+		int incX = (b.nX > a.nX) - (b.nX < a.nX);
+		int incY = (b.nY > a.nY) - (b.nY < a.nY);
+
+		if (IsBlocked(x, y))
+			return false;
+
+		int error = dx - dy;
+		dx *= 2;
+		dy *= 2;
+
+		for (int n = (dx + dy) / 2; n > 0; n--)
+		{
+			if (error > 0)
+			{
+				x += incX;
+				error -= dy;
+			}
+			else if (error < 0)
+			{
+				y += incY;
+				error += dx;
+			}
+			else
+			{
+				// Through a cell corner
+				if (IsBlocked(x + incX, y) && IsBlocked(x, y + incY))
+					return false;
+
+				x += incX;
+				y += incY;
+				error += dx - dy;
+				n--;
+			}
+
+			if (IsBlocked(x, y))
+				return false;
+		}
+
+		return true;
+	}
+
+	/* Adjacent nodes of nNode and the matching edge costs */
+	void Neighbors(const unsigned int nNode, const unsigned int*& pEdges, const float*& pCost,
+				   unsigned int& nCount) const noexcept
+	{
+		pEdges = m_vecEdges.data() + m_vecOffsets[nNode];
+		pCost = m_vecEdgeCost.data() + m_vecOffsets[nNode];
+		nCount = m_vecOffsets[nNode + 1] - m_vecOffsets[nNode];
+	}
+
+	static float GetDistance(const stCellIdxPF& a, const stCellIdxPF& b) noexcept
+	{
+		float dx = float(a.nX - b.nX), dy = float(a.nY - b.nY);
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+public: // Serialize
+	bool Save(const wchar_t* path) const
+	{
+		FILE* file = _wfsopen(path, L"wb", _SH_DENYWR);
+		if (!file) return false;
+
+		bool bRet = Save(file);
+		fclose(file);
+
+		return bRet;
+	}
+
+	bool Save(FILE* file) const
+	{
+		if (!file || m_vecOffsets.empty())
+			return false;
+
+		stVisGraphHeaderPF stHeader;
+		stHeader.nCols = m_nCols;
+		stHeader.nRows = m_nRows;
+		stHeader.nBoardHash = m_nBoardHash;
+		stHeader.nNodes = (uint32_t)m_vecNodes.size();
+		stHeader.nEdges = (uint32_t)m_vecEdges.size();
+
+		return fwrite(&stHeader, sizeof(stHeader), 1, file) == 1 &&
+			   WriteArray(file, m_vecNodes) && WriteArray(file, m_vecOffsets) &&
+			   WriteArray(file, m_vecEdges) && WriteArray(file, m_vecEdgeCost);
+	}
+
+	/* Graph must have been built from the same obstacles as the board */
+	bool Load(GridPF* pGridBoard, const wchar_t* path)
+	{
+		FILE* file = _wfsopen(path, L"rb", _SH_DENYWR);
+		if (!file) return false;
+
+		bool bRet = Load(pGridBoard, file);
+		fclose(file);
+
+		return bRet;
+	}
+
+	bool Load(GridPF* pGridBoard, FILE* file)
+	{
+		Clear();
+
+		if (!pGridBoard || !file)
+			return false;
+
+		stVisGraphHeaderPF stHeader;
+		if (fread(&stHeader, sizeof(stHeader), 1, file) != 1 ||
+			stHeader.nMagic != VISGRAPH_MAGIC || stHeader.nVersion != VISGRAPH_VERSION)
+			return false;
+
+		ReadBoard(pGridBoard);
+
+		if (stHeader.nCols != (uint32_t)m_nCols || stHeader.nRows != (uint32_t)m_nRows ||
+			stHeader.nBoardHash != m_nBoardHash)
+		{
+			Clear();
+			return false;
+		}
+
+		if (!ReadArray(file, m_vecNodes, stHeader.nNodes) ||
+			!ReadArray(file, m_vecOffsets, size_t(stHeader.nNodes) + 1) ||
+			!ReadArray(file, m_vecEdges, stHeader.nEdges) ||
+			!ReadArray(file, m_vecEdgeCost, stHeader.nEdges) || !IsConsistent())
+		{
+			Clear();
+			return false;
+		}
+
+		m_pGridBoard = pGridBoard;
+		m_nGridVersion = pGridBoard->Version();
+
+		return true;
+	}
+
+protected:
+	/* Loaded nodes, offsets and edges index inside the board and the arrays */
+	bool IsConsistent() const noexcept
+	{
+		if (m_vecOffsets.empty() || m_vecOffsets.front() != 0 || m_vecOffsets.back() != m_vecEdges.size() ||
+			m_vecEdgeCost.size() != m_vecEdges.size())
+			return false;
+
+		for (size_t i = 1; i < m_vecOffsets.size(); i++)
+		{
+			if (m_vecOffsets[i] < m_vecOffsets[i - 1])
+				return false;
+		}
+
+		for (auto& stNode : m_vecNodes)
+		{
+			if (stNode.nX < 0 || stNode.nY < 0 || stNode.nX >= m_nCols || stNode.nY >= m_nRows)
+				return false;
+		}
+
+		for (size_t i = 0; i < m_vecEdges.size(); i++)
+		{
+			if (m_vecEdges[i] >= m_vecNodes.size() || !(m_vecEdgeCost[i] >= 0.f))
+				return false;
+		}
+
+		return true;
+	}
+
+	template<typename _Ty>
+	static bool WriteArray(FILE* file, const std::vector<_Ty>& vec)
+	{
+		return vec.empty() || fwrite(vec.data(), sizeof(_Ty), vec.size(), file) == vec.size();
+	}
+
+	template<typename _Ty>
+	static bool ReadArray(FILE* file, std::vector<_Ty>& vec, const size_t szCount)
+	{
+		vec.resize(szCount);
+		return vec.empty() || fread(vec.data(), sizeof(_Ty), szCount, file) == szCount;
+	}
+
+	/* Obstacle snapshot (read by the build threads) and its hash */
+	void ReadBoard(GridPF* pGridBoard)
+	{
+		m_nCols = pGridBoard->Cols();
+		m_nRows = pGridBoard->Rows();
+		m_vecBlocked.assign(size_t(m_nCols) * m_nRows, 0);
+
+		uint64_t nHash = 1469598103934665603ull;
+
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				stCellPF* pCell = pGridBoard->Get(x, y);
+				uint8_t bBlocked = (!pCell || pCell->stData.fWeight > 0) ? 1 : 0;
+
+				m_vecBlocked[x + size_t(y) * m_nCols] = bBlocked;
+				nHash = (nHash ^ bBlocked) * 1099511628211ull;
+			}
+		}
+
+		m_nBoardHash = nHash;
+	}
+
+	void FindCorners()
+	{
+		for (int y = 0; y < m_nRows; y++)
+		{
+			for (int x = 0; x < m_nCols; x++)
+			{
+				if (IsCorner(x, y))
+					m_vecNodes.push_back({ x, y });
+			}
+		}
+	}
+
+	bool IsCorner(const int x, const int y) const noexcept
+	{
+		if (IsBlocked(x, y))
+			return false;
+
+		for (int dy = -1; dy <= 1; dy += 2)
+		{
+			for (int dx = -1; dx <= 1; dx += 2)
+			{
+				if (x + dx < 0 || y + dy < 0 || x + dx >= m_nCols || y + dy >= m_nRows)
+					continue;
+
+				// Convex vertex : the only blocked cell of the 4 around it
+				int nBlocked = IsBlocked(x + dx, y + dy) + IsBlocked(x + dx, y) + IsBlocked(x, y + dy);
+				if (nBlocked == 1)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+protected:
+	GridPF*						m_pGridBoard{ nullptr };
+	unsigned int				m_nGridVersion{ 0 };
+	int							m_nCols{ 0 };
+	int							m_nRows{ 0 };
+	uint64_t					m_nBoardHash{ 0 };
+	std::vector<uint8_t>		m_vecBlocked;
+
+	std::vector<stCellIdxPF>	m_vecNodes;
+	std::vector<unsigned int>	m_vecOffsets;
+	std::vector<unsigned int>	m_vecEdges;
+	std::vector<float>			m_vecEdgeCost;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+/***********************************************************************************/
+// VisibilityGraphSearch class
+
+/*
+* A-star over the graph, start and target are linked to the corners they see.
+* The path holds the turning cells only (like the theta-star).
+*/
+class VisibilityGraphSearch : public PathFinding
+{
+	typedef struct _stVisSearchNode
+	{
+		unsigned int	nGeneration{ 0 };
+		bool			bClosed{ false };
+		unsigned int	nPrev{ UINT32_MAX };
+		float			fCost{ -1.f };		// < 0 : not reached
+	} stVisSearchNodePF;
+
+	typedef struct _stVisOpen
+	{
+		float			fScore{ 0.f };
+		unsigned int	nNode{ 0 };
+
+		bool operator<(const _stVisOpen& other) const noexcept
+		{
+			return fScore > other.fScore;
+		}
+	} stVisOpenPF;
+
+public:
+	/* External graph (Build or Load first), nullptr : internal graph built on demand */
+	void SetGraph(VisibilityGraph* pGraph) noexcept
+	{
+		m_pGraph = pGraph;
+	}
+
+	VisibilityGraph* GetGraph() noexcept
+	{
+		return m_pGraph ? m_pGraph : &m_Graph;
+	}
+
+protected:
+	virtual void Reset()
+	{
+	}
+
+	virtual std::vector<stCellPF*> Execute(GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		std::vector<stCellPF*> path;
+
+		if (!pGridBoard)
+			return path;
+
+		VisibilityGraph* pGraph = m_pGraph;
+		if (!pGraph || !pGraph->IsValid(pGridBoard))
+		{
+			pGraph = &m_Graph;
+			if (!pGraph->IsValid(pGridBoard))
+				pGraph->Build(pGridBoard);
+		}
+
+		StatsBegin();
+
+		if (pGraph->IsBlocked(start.nX, start.nY) || pGraph->IsBlocked(target.nX, target.nY))
+		{
+			StatsEnd();
+			return path;
+		}
+
+		path.push_back(pGridBoard->Get(start));
+
+		if (start.nX == target.nX && start.nY == target.nY)
+		{
+			StatsEnd();
+			return path;
+		}
+
+		StatsLosCheck();
+		if (pGraph->IsVisible(start, target))
+		{
+			path.push_back(pGridBoard->Get(target));
+			StatsEnd();
+			return path;
+		}
+
+		if (!Search(pGraph, pGridBoard, start, target))
+		{
+			path.clear();
+			StatsEnd();
+			return path;
+		}
+
+		// Corners between start and target
+		unsigned int nStartNode = (unsigned int)pGraph->NodeCount();
+		unsigned int nTargetNode = nStartNode + 1;
+
+		m_vecChain.clear();
+		for (unsigned int n = m_Records[nTargetNode].nPrev; n != nStartNode; n = m_Records[n].nPrev)
+			m_vecChain.push_back(n);
+
+		for (auto it = m_vecChain.rbegin(); it != m_vecChain.rend(); it++)
+			path.push_back(pGridBoard->Get(pGraph->Node(*it)));
+
+		path.push_back(pGridBoard->Get(target));
+
+		StatsEnd();
+
+		return path;
+	}
+
+protected:
+	void Relax(const unsigned int nFrom, const unsigned int nTo, const float fCost,
+			   const stCellIdxPF& idxTo, const stCellIdxPF& target, GridPF* pGridBoard)
+	{
+		stVisSearchNodePF& rec = m_Records.Get(nTo);
+		if (rec.bClosed || (rec.fCost >= 0.f && rec.fCost <= fCost))
+			return;
+
+		if (rec.fCost >= 0.f)
+			StatsDecreaseKey(pGridBoard->Get(idxTo));
+
+		rec.fCost = fCost;
+		rec.nPrev = nFrom;
+
+		m_Open.Push({ fCost + VisibilityGraph::GetDistance(idxTo, target), nTo });
+		StatsPush(pGridBoard->Get(idxTo), m_Open.Size());
+	}
+
+	bool Search(VisibilityGraph* pGraph, GridPF* pGridBoard, stCellIdxPF start, stCellIdxPF target)
+	{
+		unsigned int nCount = (unsigned int)pGraph->NodeCount();
+		unsigned int nStartNode = nCount;
+		unsigned int nTargetNode = nCount + 1;
+
+		m_Records.Begin(size_t(nCount) + 2);
+
+		// Corners seeing the target
+		m_vecTargetCost.assign(nCount, -1.f);
+		for (unsigned int i = 0; i < nCount; i++)
+		{
+			StatsLosCheck();
+			if (pGraph->IsVisible(pGraph->Node(i), target))
+				m_vecTargetCost[i] = VisibilityGraph::GetDistance(pGraph->Node(i), target);
+		}
+
+		m_Open.Clear();
+		m_Records.Get(nStartNode).fCost = 0.f;
+
+		for (unsigned int i = 0; i < nCount; i++)
+		{
+			StatsLosCheck();
+			const stCellIdxPF& idx = pGraph->Node(i);
+			if (pGraph->IsVisible(start, idx))
+				Relax(nStartNode, i, VisibilityGraph::GetDistance(start, idx), idx, target, pGridBoard);
+		}
+
+		m_Records.Get(nStartNode).bClosed = true;
+
+		while (!m_Open.Empty())
+		{
+			stVisOpenPF stOpen = m_Open.Pop();
+
+			stVisSearchNodePF& rec = m_Records.Get(stOpen.nNode);
+			if (rec.bClosed)
+				continue;
+
+			rec.bClosed = true;
+
+			if (stOpen.nNode == nTargetNode)
+				return true;
+
+			const stCellIdxPF& idx = pGraph->Node(stOpen.nNode);
+			StatsPop(pGridBoard->Get(idx));
+
+			float fCost = rec.fCost;
+
+			if (m_vecTargetCost[stOpen.nNode] >= 0.f)
+				Relax(stOpen.nNode, nTargetNode, fCost + m_vecTargetCost[stOpen.nNode], target, target, pGridBoard);
+
+			const unsigned int* pEdges;
+			const float* pCost;
+			unsigned int nEdges;
+			pGraph->Neighbors(stOpen.nNode, pEdges, pCost, nEdges);
+
+			for (unsigned int e = 0; e < nEdges; e++)
+				Relax(stOpen.nNode, pEdges[e], fCost + pCost[e], pGraph->Node(pEdges[e]), target, pGridBoard);
+		}
+
+		return false;
+	}
+
+protected:
+	VisibilityGraph*				m_pGraph{ nullptr };
+	VisibilityGraph					m_Graph;
+
+	// search
+	SearchRecords<stVisSearchNodePF>	m_Records;
+	SearchOpenList<stVisOpenPF>		m_Open;
+	std::vector<float>				m_vecTargetCost;
+	std::vector<unsigned int>		m_vecChain;
+};
+
+#endif // !XVISGRAPH_H
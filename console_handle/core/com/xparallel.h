@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////////
+/*!*********************************************************************************
+*         Copyright (C) 2023-2024 thuong.nv <thuong.nv.mta@gmail.com>
+*                   MIT software Licencs, see the accompanying
+************************************************************************************
+* @brief : Parallel loop helper
+* @file  : xparallel.h
+* @create: Oct 18, 2026
+* @note  : For conditions of distribution and use, see copyright notice in readme.txt
+***********************************************************************************/
+#ifndef XPARALLEL_H
+#define XPARALLEL_H
+
+#include <thread>
+#include <future>
+#include <vector>
+#include <algorithm>
+
+namespace util
+{
+	/*******************************************************************************
+	*! @brief  : number of worker threads to use (0 : all hardware threads)
+	*! @return : unsigned int >= 1
+	*******************************************************************************/
+	inline unsigned int thread_count(unsigned int nThreads = 0) noexcept
+	{
+		if (nThreads == 0)
+			nThreads = std::thread::hardware_concurrency();
+
+		return std::max(nThreads, 1u);
+	}
+
+	/*******************************************************************************
+	*! @brief  : split [nBegin, nEnd) into contiguous chunks, one per thread
+	*! @param  : [in] fun : void(size_t nChunkBegin, size_t nChunkEnd, unsigned int nThread)
+	*! @note   : the calling thread runs the first chunk, the others run on
+	*!           std::async tasks (thread pool on msvc, new threads elsewhere) :
+	*!           meant for coarse loops (builds), not per query work. Returns once
+	*!           every chunk is done, an exception of a chunk is rethrown then
+	*******************************************************************************/
+	template<typename _Fn>
+	void parallel_for(size_t nBegin, size_t nEnd, _Fn&& fun, unsigned int nThreads = 0)
+	{
+		if (nEnd <= nBegin)
+			return;
+
+		size_t szCount = nEnd - nBegin;
+		nThreads = (unsigned int)std::min<size_t>(thread_count(nThreads), szCount);
+
+		if (nThreads <= 1)
+		{
+			fun(nBegin, nEnd, 0u);
+			return;
+		}
+
+		size_t szChunk = (szCount + nThreads - 1) / nThreads;
+
+		// A future of std::async waits for its task when destroyed : no chunk
+		// outlives the call, even when another one throws
+		std::vector<std::future<void>> vecTasks;
+		vecTasks.reserve(nThreads - 1);
+
+		for (unsigned int t = 1; t < nThreads; t++)
+		{
+			size_t szB = nBegin + t * szChunk;
+			size_t szE = std::min(szB + szChunk, nEnd);
+
+			if (szB >= szE)
+				break;
+
+			vecTasks.push_back(std::async(std::launch::async, [&fun, szB, szE, t]() { fun(szB, szE, t); }));
+		}
+
+		fun(nBegin, std::min(nBegin + szChunk, nEnd), 0u);
+
+		for (auto& task : vecTasks)
+			task.get();
+	}
+}
+
+#endif // !XPARALLEL_H
@@ -49,7 +49,7 @@ protected:
 		std::time_t end_time = std::chrono::system_clock::to_time_t(now);
 
 		struct tm  tstruct;
-		auto err = localtime_s(&tstruct, &end_time);
+		localtime_s(&tstruct, &end_time);
 		char buffer[128];
 		memset(buffer, 0, sizeof(buffer));
 
@@ -116,9 +116,9 @@ private:
 class StopWatch : public __Timer
 {
 public:
-	StopWatch() : m_dur(0.0),
-		m_bpause(true),
-		m_delapsed(0.0)
+	StopWatch() : m_delapsed(0.0),
+		m_dur(0.0),
+		m_bpause(true)
 	{
 
 	}
@@ -219,8 +219,8 @@ private:
 class FPSCounter : public __Timer
 {
 public:
-	FPSCounter() : m_fps(0), m_elapsed(0.0),
-		m_reset(0.0), m_frames(0)
+	FPSCounter() : m_fps(0), m_frames(0),
+		m_elapsed(0.0), m_reset(0.0)
 	{
 
 	}